@@ -1124,6 +1124,75 @@ const static RiverLayout rivers(1800, baseLayout);
 // This one is not fixed: [0] is a level pulled from the current game
 static vector<const ProceduralLayout*> complex_vec(2);
 
+// Recently generated stretches of abyss, so that shifting back and forth,
+// or morphing an area that was only just generated, doesn't walk the whole
+// layout tree again for every cell. Samples are a pure function of abyss
+// coordinates and depth, and each one promises not to change before its
+// changepoint, so a cell can be reused for any depth between the one it
+// was generated at and its changepoint.
+static const int ABYSS_TILE_SIZE = 16; // must be a power of two
+static const int ABYSS_TILE_CACHE_SIZE = 64;
+
+struct abyss_tile
+{
+    struct cell
+    {
+        uint32_t from, until;
+        dungeon_feature_type feat;
+        map_mask_type mask;
+    };
+
+    coord_def origin;
+    unsigned int last_used;
+    cell cells[ABYSS_TILE_SIZE * ABYSS_TILE_SIZE];
+};
+
+static vector<abyss_tile> abyss_tiles;
+static unsigned int abyss_tile_clock = 0;
+
+static abyss_tile::cell &_abyss_tile_cell(const coord_def &pt)
+{
+    const coord_def origin(pt.x & ~(ABYSS_TILE_SIZE - 1),
+                           pt.y & ~(ABYSS_TILE_SIZE - 1));
+
+    abyss_tile *tile = nullptr;
+    for (abyss_tile &t : abyss_tiles)
+    {
+        if (t.origin == origin)
+        {
+            tile = &t;
+            break;
+        }
+    }
+
+    if (!tile)
+    {
+        if (abyss_tiles.size() < ABYSS_TILE_CACHE_SIZE)
+        {
+            abyss_tiles.emplace_back();
+            tile = &abyss_tiles.back();
+        }
+        else
+        {
+            tile = &*min_element(abyss_tiles.begin(), abyss_tiles.end(),
+                                 [](const abyss_tile &a, const abyss_tile &b)
+                                 { return a.last_used < b.last_used; });
+        }
+
+        tile->origin = origin;
+        for (abyss_tile::cell &c : tile->cells)
+            c.from = 1, c.until = 0;
+    }
+
+    tile->last_used = ++abyss_tile_clock;
+    return tile->cells[(pt.y - origin.y) * ABYSS_TILE_SIZE + pt.x - origin.x];
+}
+
+static void _abyss_forget_tiles()
+{
+    abyss_tiles.clear();
+}
+
 static ProceduralSample _abyss_grid(const coord_def &p)
 {
     const coord_def pt = p + abyssal_state.major_coord;
@@ -1137,6 +1206,7 @@ static ProceduralSample _abyss_grid(const coord_def &p)
 
     if (abyssLayout == nullptr)
     {
+        _abyss_forget_tiles();
         const level_id lid = _get_random_level();
         levelLayout = new LevelLayout(lid, 5, rivers);
         complex_vec[0] = levelLayout;
@@ -1149,9 +1219,24 @@ static ProceduralSample _abyss_grid(const coord_def &p)
         }
     }
 
-    const ProceduralSample sample = (*abyssLayout)(pt, abyssal_state.depth);
+    const uint32_t depth = abyssal_state.depth;
+    abyss_tile::cell &cached = _abyss_tile_cell(pt);
+    if (cached.from <= depth && depth < cached.until)
+    {
+        const ProceduralSample sample(pt, cached.feat, cached.until,
+                                      cached.mask);
+        abyss_sample_queue.push(sample);
+        return sample;
+    }
+
+    const ProceduralSample sample = (*abyssLayout)(pt, depth);
     ASSERT(sample.feat() > DNGN_UNSEEN);
 
+    cached.from = depth;
+    cached.until = sample.changepoint();
+    cached.feat = sample.feat();
+    cached.mask = sample.mask();
+
     abyss_sample_queue.push(sample);
     return sample;
 }
@@ -1541,6 +1626,7 @@ void destroy_abyss()
         delete levelLayout;
         levelLayout = nullptr;
     }
+    _abyss_forget_tiles();
 }
 
 static colour_t _roll_abyss_floor_colour()
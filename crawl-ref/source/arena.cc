@@ -34,6 +34,7 @@
 #include "spl-miscast.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "teleport.h"
 #include "terrain.h"
 #ifdef USE_TILE
@@ -156,6 +157,7 @@ static void _results_popup(string msg, bool error=false)
 namespace arena
 {
     static bool skipped_arena_ui = true; // whether this is an interactive session
+    static bool batch = false; // fighting without any display at all
     static void write_error(const string &error);
 
     struct arena_error : public runtime_error
@@ -214,8 +216,15 @@ namespace arena
     static int trials_done = 0;
     static int team_a_wins = 0;
     static int ties        = 0;
+    static int timeouts    = 0; // also counted in ties
 
     static int turns       = 0;
+    static int turn_limit  = 0;
+
+    // How long the fights of this contest have taken.
+    static int64_t total_turns = 0;
+    static int min_turns = 0;
+    static int max_turns = 0;
 
     static bool allow_summons       = true;
     static bool allow_animate       = true;
@@ -443,6 +452,7 @@ namespace arena
         respawn         =  strip_tag(spec, "respawn");
         move_respawns   =  strip_tag(spec, "move_respawns");
         summon_throttle = strip_number_tag(spec, "summon_throttle:");
+        turn_limit      = max(0, strip_number_tag(spec, "turn_limit:"));
 
         if (real_summons && respawn)
         {
@@ -457,9 +467,10 @@ namespace arena
         name_monsters  = strip_tag(spec, "names");
         random_uniques = strip_tag(spec, "random_uniques");
 
+        // The banner only has room for two digits of trials.
         const int ntrials = strip_number_tag(spec, "t:");
-        if (ntrials != TAG_UNFOUND && ntrials >= 1 && ntrials <= 99
-            && !total_trials)
+        if (ntrials != TAG_UNFOUND && ntrials >= 1
+            && (ntrials <= 99 || batch) && !total_trials)
         {
             total_trials = ntrials;
         }
@@ -612,7 +623,8 @@ namespace arena
         for (int i = 0; i < NUM_STATS; ++i)
             you.base_stats[i] = 20;
 
-        show_fight_banner();
+        if (!batch)
+            show_fight_banner();
     }
 
     static void expand_mlist(int exp)
@@ -847,17 +859,31 @@ namespace arena
         is_respawning = false;
     }
 
+    static void record_turns()
+    {
+        total_turns += turns;
+        if (!min_turns || turns < min_turns)
+            min_turns = turns;
+        max_turns = max(max_turns, turns);
+    }
+
+    // In a batch, nothing is drawn and there's no waiting between turns.
     static void do_fight()
     {
-        viewwindow();
-        clear_messages(true);
+        if (!batch)
+        {
+            viewwindow();
+            clear_messages(true);
+        }
 
         {
             cursor_control coff(false);
-            while (fight_is_on() && !contest_cancelled)
+            while (fight_is_on() && !contest_cancelled
+                   && (!turn_limit || turns < turn_limit))
             {
 #ifdef ARENA_VERBOSE
-                mprf("---- Turn #%d ----", turns);
+                if (!batch)
+                    mprf("---- Turn #%d ----", turns);
 #endif
 
                 // Check the consistency of our book-keeping every 100 turns.
@@ -873,11 +899,15 @@ namespace arena
                 do_respawn(faction_a);
                 do_respawn(faction_b);
                 balance_spawners();
-                ui::delay(Options.view_delay);
-                clear_messages();
+                if (!batch)
+                {
+                    ui::delay(Options.view_delay);
+                    clear_messages();
+                }
                 ASSERT(you.pet_target == MHITNOT);
             }
-            viewwindow();
+            if (!batch)
+                viewwindow();
         }
 
         if (contest_cancelled)
@@ -888,15 +918,25 @@ namespace arena
             return;
         }
 
-        clear_messages();
+        if (!batch)
+            clear_messages();
 
         trials_done++;
+        record_turns();
 
+        bool was_tied = false;
+        if (faction_a.active_members > 0 && faction_b.active_members > 0)
+        {
+            mprf("Turn limit of %d reached.", turn_limit);
+            faction_a.won = faction_b.won = false;
+            ties++;
+            timeouts++;
+            was_tied = true;
+        }
         // We bother with all this to properly deal with ties, and with
         // ball lightning or ballistomycete spores winning the fight via suicide.
         // The sanity checking is probably just paranoia.
-        bool was_tied = false;
-        if (!faction_a.won && !faction_b.won)
+        else if (!faction_a.won && !faction_b.won)
         {
             if (faction_a.active_members > 0)
             {
@@ -942,6 +982,9 @@ namespace arena
         else if (faction_a.won)
             team_a_wins++;
 
+        if (batch)
+            return;
+
         show_fight_banner(true);
 
         string msg;
@@ -965,7 +1008,8 @@ namespace arena
     {
         // Clear some things that shouldn't persist across restart_after_game.
         // parse_monster_spec and setup_fight will clear the rest.
-        total_trials = trials_done = team_a_wins = ties = 0;
+        total_trials = trials_done = team_a_wins = ties = timeouts = 0;
+        total_turns = min_turns = max_turns = 0;
         contest_cancelled = false;
         is_respawning = false;
         uniques_list.clear();
@@ -981,8 +1025,11 @@ namespace arena
         // Set various options from the arena spec's tags
         parse_monster_spec(); // may throw an arena_error
 
-        crawl_view.init_geometry();
-        expand_mlist(5);
+        if (!batch)
+        {
+            crawl_view.init_geometry();
+            expand_mlist(5);
+        }
 
         for (monster_type i = MONS_0; i < NUM_MONSTERS; ++i)
         {
@@ -1017,6 +1064,31 @@ namespace arena
         }
     }
 
+    static string csv_quote(const string &field)
+    {
+        if (field.find_first_of(",\"\n") == string::npos)
+            return field;
+        return "\"" + replace_all(field, "\"", "\"\"") + "\"";
+    }
+
+    static void write_batch_header()
+    {
+        printf("matchup,team_a,team_b,trials,a_wins,b_wins,ties,timeouts,"
+               "a_win_rate,b_win_rate,mean_turns,min_turns,max_turns\n");
+    }
+
+    static void write_batch_results()
+    {
+        const int b_wins = trials_done - team_a_wins - ties;
+        const double trials = max(trials_done, 1);
+        printf("%s,%s,%s,%d,%d,%d,%d,%d,%.4f,%.4f,%.1f,%d,%d\n",
+               csv_quote(teams).c_str(), csv_quote(faction_a.desc).c_str(),
+               csv_quote(faction_b.desc).c_str(), trials_done, team_a_wins,
+               b_wins, ties, timeouts, team_a_wins / trials, b_wins / trials,
+               total_turns / trials, min_turns, max_turns);
+        fflush(stdout);
+    }
+
     static void write_error(const string &error)
     {
         if (file != nullptr)
@@ -1027,6 +1099,21 @@ namespace arena
         file = nullptr;
     }
 
+    // Fights every trial of the contest without a display, for
+    // run_arena_batch().
+    /// @throws arena_error if the specification was invalid.
+    static void simulate_batch()
+    {
+        init_level_connectivity();
+
+        do
+        {
+            setup_fight();
+            do_fight();
+        }
+        while (trials_done < total_trials);
+    }
+
     static void simulate()
     {
         init_level_connectivity();
@@ -1512,6 +1599,56 @@ static void _choose_arena_teams(newgame_def& choice,
         choice.arena_teams = default_arena_teams;
 }
 
+// Fight each matchup listed in matchups_file (one arena spec per line;
+// blank lines and lines starting with # are skipped) without initialising
+// the display, and write one line of CSV per matchup to stdout.
+NORETURN void run_arena_batch(const string &matchups_file)
+{
+    FILE *in = fopen_u(matchups_file.c_str(), "r");
+    if (!in)
+        end(1, true, "Can't open arena matchups file %s", matchups_file.c_str());
+
+    vector<string> matchups;
+    char line[1024];
+    while (fgets(line, sizeof line, in))
+    {
+        const string matchup = trimmed_string(line);
+        if (!matchup.empty() && matchup[0] != '#')
+            matchups.push_back(matchup);
+    }
+    fclose(in);
+
+    crawl_state.type = GAME_TYPE_ARENA;
+    arena::batch = true;
+    Options.view_delay = 0;
+    Options.use_animations = use_animations_type();
+    _init_arena();
+
+#ifdef WIZARD
+    // The player has wizard powers for the duration of the arena.
+    unwind_bool wiz(you.wizard, true);
+#endif
+
+    int errors = 0;
+    arena::write_batch_header();
+    for (const string &matchup : matchups)
+    {
+        try
+        {
+            arena::global_setup(matchup);
+            arena::simulate_batch();
+            arena::write_batch_results();
+        }
+        catch (const arena::arena_error &error)
+        {
+            fprintf(stderr, "%s: %s\n", matchup.c_str(), error.what());
+            errors++;
+        }
+    }
+
+    end(errors ? 1 : 0);
+}
+
 NORETURN void run_arena(const newgame_def& choice, const string &default_arena_teams)
 {
     ASSERT(crawl_state.game_is_arena());
@@ -2525,6 +2525,98 @@ int silver_damages_victim(actor* victim, int damage, string &dmg_msg, bool mount
     return ret;
 }
 
+// Monster tracers fired since the last invalidate_tracer_cache(): the
+// bolt as it was handed to the tracer, and the bolt as the tracer left it.
+// Monsters often trace the same ray several times while picking a spell or
+// missile; as long as nothing has moved since, the answer can't change.
+struct tracer_cache_entry
+{
+    bolt input;
+    bool explode_only;
+    bool explosion_hole;
+    bolt output;
+};
+
+static vector<tracer_cache_entry> tracer_cache;
+static tracer_stats tracer_stats_this_turn;
+static tracer_stats tracer_stats_last_turn;
+
+void invalidate_tracer_cache()
+{
+    tracer_cache.clear();
+}
+
+void tracer_stats_new_turn()
+{
+    tracer_stats_last_turn = tracer_stats_this_turn;
+    tracer_stats_this_turn = tracer_stats();
+}
+
+const tracer_stats &get_tracer_stats(bool this_turn)
+{
+    return this_turn ? tracer_stats_this_turn : tracer_stats_last_turn;
+}
+
+// Would tracing a and b give the same result, given an unchanged level?
+// This must cover every input the tracer reads.
+static bool _same_tracer(const bolt &a, const bolt &b)
+{
+    return a.source == b.source
+        && a.source_id == b.source_id
+        && a.target == b.target
+        && a.range == b.range
+        && a.flavour == b.flavour
+        && a.real_flavour == b.real_flavour
+        && a.origin_spell == b.origin_spell
+        && a.name == b.name
+        && a.item == b.item
+        && a.damage.num == b.damage.num
+        && a.damage.size == b.damage.size
+        && a.ench_power == b.ench_power
+        && a.hit == b.hit
+        && a.thrower == b.thrower
+        && a.ex_size == b.ex_size
+        && a.pierce == b.pierce
+        && a.is_explosion == b.is_explosion
+        && a.aimed_at_spot == b.aimed_at_spot
+        && a.affects_nothing == b.affects_nothing
+        && a.was_missile == b.was_missile
+        && a.attitude == b.attitude
+        && a.foe_ratio == b.foe_ratio
+        && a.is_targeting == b.is_targeting
+        && a.aimed_at_feet == b.aimed_at_feet
+        && a.use_target_as_pos == b.use_target_as_pos
+        && a.auto_hit == b.auto_hit
+        && a.dont_stop_player == b.dont_stop_player
+        && a.dont_stop_trees == b.dont_stop_trees;
+}
+
+// Copy over everything a tracer can change that callers may look at.
+static void _copy_tracer_result(const bolt &from, bolt &to)
+{
+    to.foe_info         = from.foe_info;
+    to.friend_info      = from.friend_info;
+    to.path_taken       = from.path_taken;
+    to.hit_count        = from.hit_count;
+    to.target           = from.target;
+    to.range            = from.range;
+    to.beam_cancelled   = from.beam_cancelled;
+    to.obvious_effect   = from.obvious_effect;
+    to.seen             = from.seen;
+    to.heard            = from.heard;
+    to.extra_range_used = from.extra_range_used;
+    to.passed_target    = from.passed_target;
+    to.aimed_at_feet    = from.aimed_at_feet;
+    to.aimed_at_spot    = from.aimed_at_spot;
+    to.use_target_as_pos = from.use_target_as_pos;
+    to.auto_hit         = from.auto_hit;
+    to.bounces          = from.bounces;
+    to.bounce_pos       = from.bounce_pos;
+    to.reflections      = from.reflections;
+    to.reflector        = from.reflector;
+    to.ray              = from.ray;
+}
+
 //  Used by monsters in "planning" which spell to cast. Fires off a "tracer"
 //  which tells the monster what it'll hit if it breathes/casts etc.
 //
@@ -2533,6 +2625,10 @@ int silver_damages_victim(actor* victim, int damage, string &dmg_msg, bool mount
 //
 //  Note that beam properties must be set, as the tracer will take them
 //  into account, as well as the monster's intelligence.
+//
+//  Monster tracers are cached until something moves or the level changes
+//  (see invalidate_tracer_cache()), so asking the same question twice in one
+//  monster's turn is cheap.
 void fire_tracer(const actor* act, bolt &pbolt, bool explode_only,
                  bool explosion_hole)
 {
@@ -2576,12 +2672,43 @@ void fire_tracer(const actor* act, bolt &pbolt, bool explode_only,
 
     pbolt.in_explosion_phase = false;
 
+    // Beams on a specific ray or with a special explosion carry state the
+    // cache doesn't look at; the player's tracers may prompt.
+    const bool cacheable = mons && !pbolt.chose_ray
+                           && !pbolt.special_explosion;
+    if (cacheable)
+    {
+        for (const tracer_cache_entry &entry : tracer_cache)
+        {
+            if (entry.explode_only == explode_only
+                && entry.explosion_hole == explosion_hole
+                && _same_tracer(entry.input, pbolt))
+            {
+                _copy_tracer_result(entry.output, pbolt);
+                tracer_stats_this_turn.reused++;
+                pbolt.is_tracer = false;
+                return;
+            }
+        }
+    }
+
+    const bolt input = cacheable ? pbolt : bolt();
+    const uint64_t rolls = rng::current_generator().get_count();
+
     // Fire!
     if (explode_only)
         pbolt.explode(false, explosion_hole);
     else
         pbolt.fire();
 
+    tracer_stats_this_turn.fired++;
+
+    // Only remember tracers that didn't roll any dice along the way (e.g.
+    // fuzzing the aim at an unseen target): replaying those would fix
+    // the outcome of the roll.
+    if (cacheable && rng::current_generator().get_count() == rolls)
+        tracer_cache.push_back({ input, explode_only, explosion_hole, pbolt });
+
     // Unset tracer flag (convenience).
     pbolt.is_tracer = false;
 }
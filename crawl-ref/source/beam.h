@@ -329,6 +329,16 @@ bool curare_actor(actor* source, actor* target, int levels, string name,
 int silver_damages_victim(actor* victim, int damage, string &dmg_msg, bool mount = false);
 void fire_tracer(const actor* act, bolt &pbolt,
                   bool explode_only = false, bool explosion_hole = false);
+
+struct tracer_stats
+{
+    int fired = 0;      // tracers actually traced
+    int reused = 0;     // tracers answered from the cache
+};
+
+void invalidate_tracer_cache();
+void tracer_stats_new_turn();
+const tracer_stats &get_tracer_stats(bool this_turn = false);
 bool imb_can_splash(coord_def origin, coord_def center,
                     vector<coord_def> path_taken, coord_def target);
 spret zapping(zap_type ztype, int power, bolt &pbolt,
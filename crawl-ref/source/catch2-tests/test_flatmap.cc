@@ -0,0 +1,48 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+#include "flatmap.h"
+#include "libutil.h"
+
+typedef SmallFlatMap<int, int, 3> small_map;
+
+TEST_CASE( "SmallFlatMap keeps keys sorted", "[single-file]" ) {
+    small_map m;
+    REQUIRE( m.empty() );
+
+    // Spill past the inline capacity and back.
+    const int keys[] = { 5, 1, 4, 2, 3 };
+    for (int k : keys)
+        m[k] = k * 10;
+
+    REQUIRE( m.size() == 5 );
+    int last = 0;
+    for (const auto &entry : m)
+    {
+        REQUIRE( entry.first > last );
+        REQUIRE( entry.second == entry.first * 10 );
+        last = entry.first;
+    }
+
+    REQUIRE( m.erase(4) == 1 );
+    REQUIRE( m.erase(4) == 0 );
+    REQUIRE( m.find(4) == m.end() );
+    REQUIRE( m.size() == 4 );
+    REQUIRE( m.find(3)->second == 30 );
+}
+
+TEST_CASE( "SmallFlatMap works with map helpers", "[single-file]" ) {
+    small_map m;
+    m[2] = 20;
+    m[1] = 10;
+
+    REQUIRE( map_find(m, 3) == nullptr );
+    REQUIRE( *map_find(m, 2) == 20 );
+    REQUIRE( lookup(m, 1, -1) == 10 );
+
+    small_map copy = m;
+    m.clear();
+    REQUIRE( m.empty() );
+    REQUIRE( copy.size() == 2 );
+    REQUIRE( copy.begin()->first == 1 );
+}
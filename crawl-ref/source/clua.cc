@@ -738,8 +738,9 @@ void CLua::init_lua()
 # endif
     _state = luaL_newstate();
 #else
-    // Throttle memory usage in managed (clua) VMs
-    _state = managed_vm? lua_newstate(_clua_allocator, this) : luaL_newstate();
+    // Pool allocations in all VMs; throttle memory usage in managed (clua)
+    // ones.
+    _state = lua_newstate(_clua_allocator, this);
 #endif
     if (!_state)
         end(1, false, "Unable to create Lua state.");
@@ -1093,23 +1094,118 @@ static int _clua_panic(lua_State *ls)
 static void *_clua_allocator(void *ud, void *ptr, size_t osize, size_t nsize)
 {
     CLua *cl = static_cast<CLua *>(ud);
-    cl->memory_used += nsize - osize;
+    if (!ptr)
+        osize = 0;
 
-    if (nsize > osize && cl->memory_used >= CLUA_MAX_MEMORY_USE * 1024
+    if (cl->managed_vm && nsize > osize
+        && cl->memory_used + (long) (nsize - osize)
+           >= CLUA_MAX_MEMORY_USE * 1024
         && cl->mixed_call_depth)
     {
         return nullptr;
     }
 
+    void *block = cl->allocator.reallocate(ptr, osize, nsize);
+    if (block || !nsize)
+        cl->memory_used += nsize - osize;
+    return block;
+}
+#endif
+
+lua_pool_allocator::~lua_pool_allocator()
+{
+    for (char *slab : m_slabs)
+        free(slab);
+}
+
+void *lua_pool_allocator::_take(size_t size)
+{
+    const size_t cls = _size_class(size);
+    if (free_block *block = m_free[cls])
+    {
+        m_free[cls] = block->next;
+        return block;
+    }
+
+    // Whatever is left at the end of the old slab is too small to bother
+    // with.
+    const size_t rounded = (cls + 1) * granule;
+    if (m_slab_end - m_slab_pos < (ptrdiff_t) rounded)
+    {
+        char *slab = static_cast<char *>(malloc(slab_size));
+        if (!slab)
+            return nullptr;
+        m_slabs.push_back(slab);
+        m_slab_pos = slab;
+        m_slab_end = slab + slab_size;
+        m_stats.reserved += slab_size;
+    }
+    void *block = m_slab_pos;
+    m_slab_pos += rounded;
+    return block;
+}
+
+void lua_pool_allocator::_release(void *block, size_t size)
+{
+    if (!_pooled(size))
+    {
+        free(block);
+        return;
+    }
+    free_block *freed = static_cast<free_block *>(block);
+    const size_t cls = _size_class(size);
+    freed->next = m_free[cls];
+    m_free[cls] = freed;
+}
+
+void *lua_pool_allocator::reallocate(void *ptr, size_t osize, size_t nsize)
+{
     if (!nsize)
     {
-        free(ptr);
+        if (ptr)
+        {
+            ++m_stats.frees;
+            m_stats.in_use -= osize;
+            _release(ptr, osize);
+        }
         return nullptr;
     }
+
+    void *block;
+    if (_pooled(nsize))
+    {
+        if (ptr && _pooled(osize) && _size_class(osize) == _size_class(nsize))
+            block = ptr;
+        else if ((block = _take(nsize)) && ptr)
+        {
+            memcpy(block, ptr, min(osize, nsize));
+            _release(ptr, osize);
+        }
+    }
+    else if (ptr && _pooled(osize))
+    {
+        if ((block = malloc(nsize)))
+        {
+            memcpy(block, ptr, osize);
+            _release(ptr, osize);
+        }
+    }
     else
-        return realloc(ptr, nsize);
+        block = realloc(ptr, nsize);
+
+    if (!block)
+        return nullptr;
+
+    if (ptr)
+        ++m_stats.reallocs;
+    else
+        ++m_stats.allocs;
+    if (_pooled(nsize))
+        ++m_stats.pooled;
+    m_stats.in_use += nsize - osize;
+    m_stats.peak = max(m_stats.peak, m_stats.in_use);
+    return block;
 }
-#endif
 
 static void _clua_throttle_hook(lua_State *ls, lua_Debug *dbg)
 {
@@ -11,6 +11,7 @@ extern "C" {
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "maybe-bool.h"
 
@@ -41,6 +42,61 @@ private:
     static lua_clua_map lua_map;
 };
 
+// Allocation counts for one Lua state. Sizes are what Lua asked for, not
+// what the pool or malloc actually set aside.
+struct lua_alloc_stats
+{
+    unsigned long allocs = 0;   // new blocks
+    unsigned long reallocs = 0; // blocks resized
+    unsigned long frees = 0;
+    unsigned long pooled = 0;   // allocs and reallocs served by the pool
+    size_t in_use = 0;
+    size_t peak = 0;
+    size_t reserved = 0;        // bytes in pool slabs
+};
+
+// Memory for a Lua state. Lua spends most of its time making and dropping
+// small blocks (table nodes, short strings, closures), so those are handed
+// out from per-size free lists carved from large slabs rather than going to
+// malloc one by one; anything bigger still goes to malloc. Lua always says
+// how big a block is when resizing or freeing it, so blocks carry no header.
+// Slabs are only given back when the pool is destroyed, after lua_close().
+class lua_pool_allocator
+{
+public:
+    lua_pool_allocator() = default;
+    lua_pool_allocator(const lua_pool_allocator &) = delete;
+    lua_pool_allocator &operator=(const lua_pool_allocator &) = delete;
+    ~lua_pool_allocator();
+
+    // Same contract as a lua_Alloc, with osize 0 for new blocks.
+    void *reallocate(void *ptr, size_t osize, size_t nsize);
+
+    const lua_alloc_stats &stats() const { return m_stats; }
+
+private:
+    static const size_t granule = 16;
+    static const size_t max_pooled = 256;
+    static const size_t num_classes = max_pooled / granule;
+    static const size_t slab_size = 64 * 1024;
+
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    static bool _pooled(size_t size) { return size <= max_pooled; }
+    static size_t _size_class(size_t size) { return (size - 1) / granule; }
+    void *_take(size_t size);
+    void _release(void *block, size_t size);
+
+    free_block *m_free[num_classes] = { };
+    vector<char *> m_slabs;
+    char *m_slab_pos = nullptr;
+    char *m_slab_end = nullptr;
+    lua_alloc_stats m_stats;
+};
+
 class lua_shutdown_listener
 {
 public:
@@ -164,6 +220,7 @@ public:
     int max_lua_call_depth;
 
     long memory_used;
+    lua_pool_allocator allocator;
 
     static const int MAX_THROTTLE_SLEEPS = 100;
 
@@ -164,5 +164,10 @@ function ch_stash_search_annotate_item(it)
   return annot
 end
 
+-- The stash tracker indexes these annotations, knowing what they depend on;
+-- if an rc file replaces the function, searches go back to checking every
+-- stash.
+stock_ch_stash_search_annotate_item = ch_stash_search_annotate_item
+
 --- If you want dumps (.lst files) to be annotated, uncomment this line:
 -- ch_stash_dump_annotate_item = ch_stash_search_annotate_item
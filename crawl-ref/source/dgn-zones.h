@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @brief Connected-zone labelling for the level builders.
+ *
+ * Splits the passable cells of a box into 8-connected zones in two linear
+ * scans: the first hands out provisional labels, merging those of touching
+ * cells with union-find, and the second resolves each cell to its zone and
+ * gathers per-zone flags (stairs, vault cells, ...). Unlike flood-filling
+ * one zone at a time, this never rescans the box per zone.
+**/
+
+#pragma once
+
+#include <vector>
+
+struct zone_map
+{
+    coord_def tl, br;
+    // Zone of each cell in the box (row-major), 0 if impassable. Zones are
+    // numbered from 1 in the order a row-major scan first reaches them.
+    vector<int> zone;
+    // The flags of each zone's cells or'd together, indexed by zone; entry
+    // 0 is unused.
+    vector<unsigned> flags;
+
+    int width() const { return br.x - tl.x + 1; }
+    int count() const { return flags.size() - 1; }
+
+    int &operator()(const coord_def &c)
+    {
+        return zone[(c.y - tl.y) * width() + c.x - tl.x];
+    }
+};
+
+// Label the zones of cells within [tl, br] for which passable(c) holds.
+// cell_flags(c) is asked once for each passable cell.
+template <class P, class F>
+void label_zones(zone_map &zones, const coord_def &tl, const coord_def &br,
+                 P passable, F cell_flags)
+{
+    zones.tl = tl;
+    zones.br = br;
+    zones.flags.assign(1, 0);
+
+    const int w = br.x - tl.x + 1;
+    const int h = br.y - tl.y + 1;
+    if (w <= 0 || h <= 0)
+    {
+        zones.zone.clear();
+        return;
+    }
+
+    vector<int> &zone = zones.zone;
+    zone.assign(w * h, 0);
+
+    // Provisional labels; each one's parent is a smaller label in the same
+    // zone, or itself.
+    vector<int> parent(1, 0);
+    auto find = [&parent](int label)
+    {
+        while (parent[label] != label)
+            label = parent[label] = parent[parent[label]];
+        return label;
+    };
+
+    // The neighbours a row-major scan has already visited.
+    static const coord_def earlier[] = { {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            if (!passable(coord_def(tl.x + x, tl.y + y)))
+                continue;
+
+            int label = 0;
+            for (const coord_def &d : earlier)
+            {
+                const int nx = x + d.x, ny = y + d.y;
+                if (nx < 0 || nx >= w || ny < 0 || !zone[ny * w + nx])
+                    continue;
+
+                const int root = find(zone[ny * w + nx]);
+                if (!label)
+                    label = root;
+                else if (root < label)
+                {
+                    parent[label] = root;
+                    label = root;
+                }
+                else if (root > label)
+                    parent[root] = label;
+            }
+
+            if (!label)
+            {
+                label = parent.size();
+                parent.push_back(label);
+            }
+            zone[y * w + x] = label;
+        }
+
+    vector<int> final_label(parent.size(), 0);
+    for (int i = 0, size = zone.size(); i < size; ++i)
+    {
+        if (!zone[i])
+            continue;
+
+        int &label = final_label[find(zone[i])];
+        if (!label)
+        {
+            label = zones.flags.size();
+            zones.flags.push_back(0);
+        }
+        zone[i] = label;
+        zones.flags[label] |= cell_flags(coord_def(tl.x + i % w,
+                                                   tl.y + i / w));
+    }
+}
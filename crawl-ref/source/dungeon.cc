@@ -8,6 +8,7 @@
 #include "dungeon.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -34,6 +35,7 @@
 #include "dgn-height.h"
 #include "dgn-overview.h"
 #include "dgn-shoals.h"
+#include "dgn-zones.h"
 #include "end.h"
 #include "files.h"
 #include "flood-find.h"
@@ -247,6 +249,49 @@ set<string> &get_uniq_map_names()
         return you.uniq_map_names;
 }
 
+levelgen_timings dgn_builder_timings;
+
+void dgn_reset_builder_timings()
+{
+    dgn_builder_timings = levelgen_timings();
+}
+
+const char *levelgen_phase_name(levelgen_phase phase)
+{
+    static const char *names[] =
+    {
+        "layout", "vaults", "monsters", "items", "connectivity",
+    };
+    COMPILE_CHECK(ARRAYSZ(names) == NUM_LEVELGEN_PHASES);
+    return names[phase];
+}
+
+// Adds the time until it goes out of scope to a builder timing.
+class builder_timer
+{
+public:
+    builder_timer(double &_total)
+        : total(_total), start(chrono::steady_clock::now())
+    {
+    }
+
+    ~builder_timer()
+    {
+        total += chrono::duration<double>(chrono::steady_clock::now()
+                                          - start).count();
+    }
+
+private:
+    double &total;
+    chrono::steady_clock::time_point start;
+};
+
+#define TIME_PHASE(which, call) \
+    do { \
+        builder_timer _timer(dgn_builder_timings.phase[which]); \
+        call; \
+    } while (false)
+
 /**********************************************************************
  * builder() - kickoff for the dungeon generator.
  *********************************************************************/
@@ -276,6 +321,8 @@ bool builder(bool enable_random_maps)
 
     unwind_bool levelgen(crawl_state.generating_level, true);
     rng::generator levelgen_rng(you.where_are_you);
+    builder_timer timer(dgn_builder_timings.total);
+    dgn_builder_timings.levels++;
 
 #ifdef DEBUG_DIAGNOSTICS // no point in enabling unless dprf works
     CrawlHashTable &debug_logs = you.props["debug_builder_logs"].get_table();
@@ -352,6 +399,7 @@ static bool _build_level_vetoable(bool enable_random_maps)
 #ifdef DEBUG_STATISTICS
         mapstat_report_map_veto(e.what());
 #endif
+        dgn_builder_timings.vetoes++;
         // try not to lose any ghosts that have been placed
         save_ghosts(ghost_demon::find_ghosts(false), false);
         return false;
@@ -362,6 +410,7 @@ static bool _build_level_vetoable(bool enable_random_maps)
     if (crawl_state.game_standard_levelgen()
         && !_valid_dungeon_level())
     {
+        dgn_builder_timings.vetoes++;
         return false;
     }
 
@@ -970,75 +1019,115 @@ static bool _is_exit_stair(const coord_def &c)
 //
 // If fill is non-zero, it fills any disconnected regions with fill.
 //
+// Leaves each passable square's zone in travel_point_distance, for the
+// benefit of debugging map dumps.
+//
 static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
                 bool choose_stairless,
                 dungeon_feature_type fill,
                 bool (*passable)(const coord_def &) = _dgn_square_is_passable)
 {
+    enum { ZONE_EXIT = 1, ZONE_VAULT = 2 };
+
+    bool (*is_exit)(const coord_def &) =
+        at_branch_bottom() ? _is_upwards_exit_stair : _is_exit_stair;
+
+    zone_map zones;
+    label_zones(zones, coord_def(x1, y1), coord_def(x2, y2),
+                [passable](const coord_def &c)
+                {
+                    return map_bounds(c) && passable(c);
+                },
+                [=](const coord_def &c)
+                {
+                    unsigned flags = 0;
+                    if (choose_stairless && is_exit(c))
+                        flags |= ZONE_EXIT;
+                    // Don't fill in areas connected to vaults.
+                    // We want vaults to be accessible; if the area is
+                    // disconneted from the rest of the level, this will
+                    // cause the level to be vetoed later on.
+                    if (fill && map_masked(c, MMT_VAULT))
+                        flags |= ZONE_VAULT;
+                    return flags;
+                });
+
     memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
-    int nzones = 0;
+    for (rectangle_iterator ri(zones.tl, zones.br); ri; ++ri)
+    {
+        const int zone = zones(*ri);
+        if (!zone)
+            continue;
+
+        travel_point_distance[ri->x][ri->y] = zone;
+
+        // If we want only stairless zones, screen out zones that did
+        // have stairs.
+        if (fill && !(zones.flags[zone] & (ZONE_EXIT | ZONE_VAULT)))
+            _set_grd(*ri, fill);
+    }
+
     int ngood = 0;
-    for (int y = y1; y <= y2 ; ++y)
+    if (choose_stairless)
     {
-        for (int x = x1; x <= x2; ++x)
+        for (int zone = 1; zone <= zones.count(); ++zone)
+            if (zones.flags[zone] & ZONE_EXIT)
+                ++ngood;
+    }
+
+    return zones.count() - ngood;
+}
+
+// The zone-at-a-time flood fill _process_disconnected_zones() used to do,
+// kept for dgn_check_zone_labels().
+static int _count_disconnected_zones_by_flood(bool choose_stairless)
+{
+    memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
+    int nzones = 0;
+    int ngood = 0;
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
         {
-            if (!map_bounds(x, y)
-                || travel_point_distance[x][y]
-                || !passable(coord_def(x, y)))
+            if (travel_point_distance[x][y]
+                || !_dgn_square_is_passable(coord_def(x, y)))
             {
                 continue;
             }
 
-            const bool found_exit_stair =
-                _dgn_fill_zone(coord_def(x, y), ++nzones,
+            if (_dgn_fill_zone(coord_def(x, y), ++nzones,
                                _dgn_point_record_stub,
-                               passable,
+                               _dgn_square_is_passable,
                                choose_stairless ? (at_branch_bottom() ?
                                                    _is_upwards_exit_stair :
-                                                   _is_exit_stair) : nullptr);
-
-            // If we want only stairless zones, screen out zones that did
-            // have stairs.
-            if (choose_stairless && found_exit_stair)
-                ++ngood;
-            else if (fill)
+                                                   _is_exit_stair) : nullptr)
+                && choose_stairless)
             {
-                // Don't fill in areas connected to vaults.
-                // We want vaults to be accessible; if the area is disconneted
-                // from the rest of the level, this will cause the level to be
-                // vetoed later on.
-                bool veto = false;
-                vector<coord_def> coords;
-                for (int fy = y1; fy <= y2 ; ++fy)
-                {
-                    for (int fx = x1; fx <= x2; ++fx)
-                    {
-                        if (travel_point_distance[fx][fy] == nzones)
-                        {
-                            if (map_masked(coord_def(fx, fy), MMT_VAULT))
-                            {
-                                veto = true;
-                                break;
-                            }
-                            else
-                                coords.emplace_back(fx, fy);
-                        }
-                    }
-                    if (veto)
-                        break;
-                }
-                if (!veto)
-                {
-                    for (auto c : coords)
-                        _set_grd(c, fill);
-                }
+                ++ngood;
             }
         }
-    }
 
     return nzones - ngood;
 }
 
+// Checks that labelling the current level's zones in one go gives the same
+// zones and counts as flood-filling them one at a time.
+bool dgn_check_zone_labels()
+{
+    for (bool choose_stairless : { false, true })
+    {
+        const int count = dgn_count_disconnected_zones(choose_stairless);
+        const travel_distance_grid_t &labels = travel_point_distance;
+        const vector<short> zones(&labels[0][0], &labels[0][0] + GXM * GYM);
+
+        if (_count_disconnected_zones_by_flood(choose_stairless) != count
+            || !equal(zones.begin(), zones.end(), &labels[0][0]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 int dgn_count_disconnected_zones(bool choose_stairless,
                                  dungeon_feature_type fill)
 {
@@ -1423,9 +1512,11 @@ void dgn_reset_level(bool enable_random_maps)
     // Initialise all items.
     for (int i = 0; i < MAX_ITEMS; i++)
         init_item(i);
+    rebuild_item_free_list();
 
     // Reset all monsters.
     reset_all_monsters();
+    rebuild_monster_free_list();
     init_anon();
 
     // ... and Pan/regular spawn lists.
@@ -1844,6 +1935,7 @@ void fixup_misplaced_items()
         item.base_type = OBJ_UNASSIGNED;
         item.quantity = 0;
         item.pos.reset();
+        item_slot_freed(item.index());
     }
 }
 
@@ -2820,10 +2912,11 @@ static void _post_vault_build()
 
 static void _build_dungeon_level()
 {
-    bool place_vaults = _builder_by_type();
+    bool place_vaults;
+    TIME_PHASE(LEVELGEN_LAYOUT, place_vaults = _builder_by_type());
 
     if (player_in_branch(BRANCH_SLIME))
-        _slime_connectivity_fixup();
+        TIME_PHASE(LEVELGEN_CONNECTIVITY, _slime_connectivity_fixup());
 
     // Now place items, mons, gates, etc.
     // Stairs must exist by this point (except in Shoals where they are
@@ -2848,6 +2941,8 @@ static void _build_dungeon_level()
     {
         if (place_vaults)
         {
+            builder_timer vault_timer(
+                dgn_builder_timings.phase[LEVELGEN_VAULTS]);
             // Moved branch entries to place first so there's a good
             // chance of having room for a vault
             _place_branch_entrances(true);
@@ -2857,6 +2952,8 @@ static void _build_dungeon_level()
         }
         else
         {
+            builder_timer vault_timer(
+                dgn_builder_timings.phase[LEVELGEN_VAULTS]);
             // Place any branch entries vaultlessly
             _place_branch_entrances(false);
             // Still place chance vaults - important things like Abyss,
@@ -2879,12 +2976,12 @@ static void _build_dungeon_level()
         _fixup_sewer_stairs();
 
         // Any vault-placement activity must happen before this check.
-        _dgn_verify_connectivity(nvaults);
+        TIME_PHASE(LEVELGEN_CONNECTIVITY, _dgn_verify_connectivity(nvaults));
 
-        _builder_monsters();
+        TIME_PHASE(LEVELGEN_MONSTERS, _builder_monsters());
 
         // Place items.
-        _builder_items();
+        TIME_PHASE(LEVELGEN_ITEMS, _builder_items());
 
         _fixup_walls();
 
@@ -2924,7 +3021,7 @@ static void _build_dungeon_level()
     link_items();
 
     if (crawl_state.game_standard_levelgen())
-        _connectivity_fixup();
+        TIME_PHASE(LEVELGEN_CONNECTIVITY, _connectivity_fixup());
 }
 
 static void _dgn_set_floor_colours()
@@ -6408,6 +6505,7 @@ static void _stock_shop_item(int j, shop_type shop_type_,
             if (!one_chance_in(stocked[mitm[item_index].sub_type] + 1))
             {
                 mitm[item_index].clear();
+                item_slot_freed(item_index);
                 item_index = NON_ITEM; // try again
             }
         }
@@ -6417,7 +6515,10 @@ static void _stock_shop_item(int j, shop_type shop_type_,
 
         // Reset object and try again.
         if (item_index != NON_ITEM)
+        {
             mitm[item_index].clear();
+            item_slot_freed(item_index);
+        }
     }
 
     ASSERT(item_index != NON_ITEM);
@@ -202,6 +202,30 @@ void write_level_connectivity(writer &th);
 
 bool builder(bool enable_random_maps = true);
 
+// The parts of builder() that dgn_builder_timings breaks down the time of.
+enum levelgen_phase
+{
+    LEVELGEN_LAYOUT,        // _builder_by_type()
+    LEVELGEN_VAULTS,        // branch entrances, chance vaults, minivaults...
+    LEVELGEN_MONSTERS,
+    LEVELGEN_ITEMS,
+    LEVELGEN_CONNECTIVITY,  // checking and fixing it up
+    NUM_LEVELGEN_PHASES
+};
+
+// What builder() has done since the timings were last reset.
+struct levelgen_timings
+{
+    int levels;                         // levels built
+    int vetoes;                         // attempts thrown away
+    double total;                       // seconds in builder()
+    double phase[NUM_LEVELGEN_PHASES];  // seconds in each phase
+};
+
+extern levelgen_timings dgn_builder_timings;
+void dgn_reset_builder_timings();
+const char *levelgen_phase_name(levelgen_phase phase);
+
 void dgn_clear_vault_placements();
 void dgn_erase_unused_vault_placements();
 void dgn_flush_map_memory();
@@ -268,6 +292,7 @@ const vault_placement *dgn_register_place(const vault_placement &place,
 int dgn_count_disconnected_zones(
     bool choose_stairless,
     dungeon_feature_type fill = DNGN_UNSEEN);
+bool dgn_check_zone_labels();
 
 void dgn_replace_area(const coord_def& p1, const coord_def& p2,
                       dungeon_feature_type replace,
@@ -188,7 +188,7 @@ exclude_set::exclude_set()
 void exclude_set::clear()
 {
     exclude_roots.clear();
-    exclude_points.clear();
+    exclude_count.clear();
 }
 
 void exclude_set::erase(const coord_def &p)
@@ -198,14 +198,13 @@ void exclude_set::erase(const coord_def &p)
     if (it == exclude_roots.end())
         return;
 
-    travel_exclude old_ex = it->second;
+    remove_exclude_points(it->second);
     exclude_roots.erase(it);
-
-    recompute_excluded_points();
 }
 
 void exclude_set::add_exclude(travel_exclude &ex)
 {
+    erase(ex.pos);
     add_exclude_points(ex);
     exclude_roots[ex.pos] = ex;
 }
@@ -218,52 +217,69 @@ void exclude_set::add_exclude(const coord_def &p, int radius,
     add_exclude(ex);
 }
 
+// Work out which squares ex covers, and count them as excluded.
 void exclude_set::add_exclude_points(travel_exclude& ex)
 {
+    if (!ex.uptodate)
+        ex.set_los();
+    else if (ex.radius > 1)
+        ex.los.update();
+
+    ex.points.clear();
     if (ex.radius == 0)
+        ex.points.push_back(ex.pos);
+    else
     {
-        exclude_points.insert(ex.pos);
-        return;
+        for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
+            if (ex.affects(*ri))
+                ex.points.push_back(*ri);
     }
 
-    if (!ex.uptodate)
-        ex.set_los();
-    else
-        ex.los.update();
+    if (exclude_count.empty())
+        exclude_count.resize(GXM * GYM, 0);
+    for (const coord_def &p : ex.points)
+        ++exclude_count[p.x * GYM + p.y];
+}
 
-    for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
-        if (ex.affects(*ri))
-            exclude_points.insert(*ri);
+void exclude_set::remove_exclude_points(travel_exclude& ex)
+{
+    for (const coord_def &p : ex.points)
+        --exclude_count[p.x * GYM + p.y];
+    ex.points.clear();
 }
 
-void exclude_set::update_excluded_points(bool recompute_los)
+// Bring the exclusions whose LOS might have changed up to date, leaving
+// the others' squares alone.
+void exclude_set::update_excluded_points()
 {
-    for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
+    for (auto &entry : exclude_roots)
     {
-        travel_exclude &ex = it->second;
-        if (!ex.uptodate)
-        {
-            recompute_excluded_points(recompute_los);
-            return;
-        }
+        travel_exclude &ex = entry.second;
+        if (ex.uptodate)
+            continue;
+
+        remove_exclude_points(ex);
+        add_exclude_points(ex);
     }
 }
 
 void exclude_set::recompute_excluded_points(bool recompute_los)
 {
-    exclude_points.clear();
-    for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
+    exclude_count.clear();
+    for (auto &entry : exclude_roots)
     {
-        travel_exclude &ex = it->second;
+        travel_exclude &ex = entry.second;
         if (recompute_los)
-            ex.set_los();
+            ex.uptodate = false;
         add_exclude_points(ex);
     }
 }
 
 bool exclude_set::is_excluded(const coord_def &p) const
 {
-    return exclude_points.count(p);
+    return !exclude_count.empty()
+           && p.x >= 0 && p.x < GXM && p.y >= 0 && p.y < GYM
+           && exclude_count[p.x * GYM + p.y];
 }
 
 bool exclude_set::is_exclude_root(const coord_def &p) const
@@ -336,7 +352,7 @@ void update_exclusion_los(vector<coord_def> changed)
     for (coord_def c : changed)
         _mark_excludes_non_updated(c);
 
-    curr_excludes.update_excluded_points(true);
+    curr_excludes.update_excluded_points();
 }
 
 bool is_excluded(const coord_def &p, const exclude_set &exc)
@@ -493,7 +509,7 @@ void set_exclude(const coord_def &p, int radius, bool autoexcl, bool vaultexcl,
 
         exc->radius   = radius;
         exc->uptodate = false;
-        curr_excludes.recompute_excluded_points();
+        curr_excludes.update_excluded_points();
     }
     else
     {
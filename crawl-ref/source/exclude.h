@@ -29,6 +29,8 @@ public:
     bool          autoex;       // Was set automatically.
     string        desc;         // Exclusion description.
     bool          vault;        // Is this exclusion set by a vault?
+    // The squares this exclusion covered when exclude_set last looked.
+    vector<coord_def> points;
 
     travel_exclude(const coord_def &p, int r = LOS_RADIUS,
                    bool autoex = false, string desc = "",
@@ -64,7 +66,7 @@ public:
                      string desc = "",
                      bool vaultexcl = false);
 
-    void update_excluded_points(bool recompute_los = false);
+    void update_excluded_points();
     void recompute_excluded_points(bool recompute_los = false);
 
     travel_exclude* get_exclude_root(const coord_def &p);
@@ -83,13 +85,14 @@ public:
     iterator  end();
 
 private:
-    typedef set<coord_def> exclset;
-
     exclmap exclude_roots;
-    exclset exclude_points;
+    // How many exclusions cover each square (indexed x * GYM + y); empty
+    // while there are no exclusions, to keep per-level copies cheap.
+    vector<unsigned short> exclude_count;
 
 private:
     void add_exclude_points(travel_exclude& ex);
+    void remove_exclude_points(travel_exclude& ex);
 };
 
 extern exclude_set curr_excludes; // in travel.cc
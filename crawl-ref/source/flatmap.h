@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @brief Small sorted associative container with inline storage.
+ *
+ * A drop-in replacement for std::map for small key sets: entries are kept
+ * sorted in a contiguous buffer, the first SIZE of which live inline in the
+ * object itself. Lookups are a binary search over at most a handful of
+ * entries and iteration is a linear walk, with no per-node allocation.
+ *
+ * Unlike std::map, inserting or erasing an entry invalidates iterators and
+ * references to *other* entries too; don't hold on to them across calls
+ * that might change the set of keys.
+**/
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+template <class KEY, class VALUE, int SIZE> class SmallFlatMap
+{
+public:
+    typedef KEY                     key_type;
+    typedef VALUE                   mapped_type;
+    typedef pair<KEY, VALUE>        value_type;
+    typedef value_type&             reference;
+    typedef const value_type&       const_reference;
+
+    typedef unsigned long           size_type;
+
+    typedef value_type*             iterator;
+    typedef const value_type*       const_iterator;
+
+public:
+    SmallFlatMap() : m_size(0) { }
+
+    // ----- Size -----
+    bool empty() const { return m_size == 0; }
+    size_type size() const { return m_size; }
+
+    // ----- Iterating -----
+    iterator begin() { return data(); }
+    const_iterator begin() const { return data(); }
+    iterator end() { return data() + m_size; }
+    const_iterator end() const { return data() + m_size; }
+
+    // ----- Lookup -----
+    iterator find(const KEY &key)
+    {
+        iterator it = _lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    const_iterator find(const KEY &key) const
+    {
+        const_iterator it = const_cast<SmallFlatMap*>(this)->_lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    size_type count(const KEY &key) const
+    {
+        return find(key) != end();
+    }
+
+    VALUE &operator[](const KEY &key)
+    {
+        iterator it = _lower_bound(key);
+        if (it != end() && it->first == key)
+            return it->second;
+        return _insert_at(it - begin(), value_type(key, VALUE()))->second;
+    }
+
+    // ----- Modification -----
+    void clear()
+    {
+        for (int i = 0; i < m_size && m_spill.empty(); ++i)
+            m_inline[i] = value_type();
+        m_spill.clear();
+        m_size = 0;
+    }
+
+    size_type erase(const KEY &key)
+    {
+        iterator it = find(key);
+        if (it == end())
+            return 0;
+
+        erase(it);
+        return 1;
+    }
+
+    void erase(iterator it)
+    {
+        if (!m_spill.empty())
+            m_spill.erase(m_spill.begin() + (it - begin()));
+        else
+        {
+            move(it + 1, end(), it);
+            m_inline[m_size - 1] = value_type();
+        }
+        --m_size;
+    }
+
+private:
+    // While everything fits, the entries live in m_inline[0, m_size);
+    // once we've outgrown that, all of them live in m_spill instead.
+    value_type *data()
+    {
+        return m_spill.empty() ? m_inline : m_spill.data();
+    }
+
+    const value_type *data() const
+    {
+        return m_spill.empty() ? m_inline : m_spill.data();
+    }
+
+    iterator _lower_bound(const KEY &key)
+    {
+        return lower_bound(begin(), end(), key,
+                           [](const value_type &entry, const KEY &k)
+                           { return entry.first < k; });
+    }
+
+    iterator _insert_at(int pos, const value_type &entry)
+    {
+        if (m_spill.empty() && m_size < SIZE)
+        {
+            move_backward(m_inline + pos, m_inline + m_size,
+                          m_inline + m_size + 1);
+            m_inline[pos] = entry;
+        }
+        else
+        {
+            if (m_spill.empty())
+            {
+                m_spill.reserve(SIZE * 2);
+                m_spill.assign(m_inline, m_inline + m_size);
+                for (int i = 0; i < m_size; ++i)
+                    m_inline[i] = value_type();
+            }
+            m_spill.insert(m_spill.begin() + pos, entry);
+        }
+        ++m_size;
+        return begin() + pos;
+    }
+
+private:
+    value_type m_inline[SIZE];
+    vector<value_type> m_spill;
+    int m_size;
+};
@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Free-slot tracking for the fixed-size item and monster tables.
+ *
+ * Keeps a min-heap of the slots that were free when last looked at, so
+ * that handing out the lowest free slot doesn't mean walking the whole
+ * table. Slots get freed in more ways than anyone reports, and filled
+ * without going through take(), so the heap only holds hints: take()
+ * checks each one against the table before handing it out, and when it
+ * runs out of hints it rescans the table, picking up anything that was
+ * freed behind its back.
+**/
+
+#pragma once
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+// While enabled (by debug.check_free_slots()), every take() also walks the
+// table from the start, as allocation used to, and counts the times the
+// two disagree.
+struct free_slot_checks
+{
+    bool enabled = false;
+    int mismatches = 0;
+};
+
+inline free_slot_checks &free_slot_check_state()
+{
+    static free_slot_checks state;
+    return state;
+}
+
+template <int SIZE>
+class free_slot_list
+{
+public:
+    free_slot_list() : listed(SIZE, false) { }
+
+    // Forget all hints and list every slot for which is_free(slot) holds.
+    template <class F>
+    void rebuild(F is_free)
+    {
+        vector<int> slots;
+        listed.assign(SIZE, false);
+        for (int slot = 0; slot < SIZE; ++slot)
+        {
+            if (is_free(slot))
+            {
+                slots.push_back(slot);
+                listed[slot] = true;
+            }
+        }
+        // Ascending order is already a valid min-heap.
+        heap = slot_heap(greater<int>(), move(slots));
+    }
+
+    // Note that slot has just been freed.
+    void release(int slot)
+    {
+        if (slot >= 0 && slot < SIZE && !listed[slot])
+        {
+            listed[slot] = true;
+            heap.push(slot);
+        }
+    }
+
+    // Returns the lowest listed slot below limit that is still free, or -1
+    // if there is none even after rescanning the table.
+    template <class F>
+    int take(int limit, F is_free)
+    {
+        const int slot = _take(limit, is_free);
+        free_slot_checks &checks = free_slot_check_state();
+        if (checks.enabled)
+        {
+            int first = 0;
+            while (first < limit && !is_free(first))
+                ++first;
+            if (slot != (first < limit ? first : -1))
+                ++checks.mismatches;
+        }
+        return slot;
+    }
+
+private:
+    typedef priority_queue<int, vector<int>, greater<int>> slot_heap;
+
+    template <class F>
+    int _take(int limit, F is_free)
+    {
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            while (!heap.empty() && heap.top() < limit)
+            {
+                const int slot = heap.top();
+                heap.pop();
+                listed[slot] = false;
+                if (is_free(slot))
+                    return slot;
+            }
+            if (!pass)
+                rebuild(is_free);
+        }
+        return -1;
+    }
+
+    slot_heap heap;
+    vector<bool> listed;
+};
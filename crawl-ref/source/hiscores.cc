@@ -19,6 +19,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <memory>
+#include <fcntl.h>
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
@@ -49,6 +50,7 @@
 #include "state.h"
 #include "status.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #ifdef USE_TILE
  #include "tilepick.h"
 #endif
@@ -68,10 +70,7 @@ static unique_ptr<scorefile_entry> hs_list[SCORE_FILE_ENTRIES];
 static int hs_list_size = 0;
 static bool hs_list_initalized = false;
 
-static FILE *_hs_open(const char *mode, const string &filename);
-static void  _hs_close(FILE *handle);
 static bool  _hs_read(FILE *scores, scorefile_entry &dest);
-static void  _hs_write(FILE *scores, scorefile_entry &entry);
 static time_t _parse_time(const string &st);
 static string _xlog_escape(const string &s);
 static string _xlog_unescape(const string &s);
@@ -97,92 +96,368 @@ static string _log_file_name()
     return Options.shared_dir + "logfile" + crawl_state.game_type_qualifier();
 }
 
-int hiscores_new_entry(const scorefile_entry &ne)
+// Records and bytes written to the logfile, milestones and scores log by
+// the current game.
+static struct
 {
-    unwind_bool score_update(crawl_state.updating_scores, true);
+    time_t game;
+    unsigned long records;
+    unsigned long bytes;
+} xlog_written;
 
-    FILE *scores;
-    int i;
-    bool inserted = false;
-    int newest_entry = -1;
+void xlog_write_stats(unsigned long &records, unsigned long &bytes)
+{
+    if (xlog_written.game != you.birth_time)
+        xlog_written = { you.birth_time, 0, 0 };
+    records = xlog_written.records;
+    bytes = xlog_written.bytes;
+}
 
-    // open highscore file (reading) -- nullptr is fatal!
-    //
-    // Opening as a+ instead of r+ to force an exclusive lock (see
-    // hs_open) and to create the file if it's not there already.
-    scores = _hs_open("a+", _score_file_name());
-    if (scores == nullptr)
-        end(1, true, "failed to open score file for writing");
+static void _xlog_count_write(size_t bytes)
+{
+    unsigned long records, total;
+    xlog_write_stats(records, total);
+    ++xlog_written.records;
+    xlog_written.bytes += bytes;
+}
+
+// Append one finished line to an xlog-style file. Where we can, this is a
+// single write() to a file opened with O_APPEND, which lands in one piece
+// at the end of the file however many other games are writing to it, so
+// we needn't lock it (and hold up anything reading it). Elsewhere, fall
+// back to locking the file around the write.
+static bool _xlog_append(const string &filename, const string &line)
+{
+    bool ok = false;
+#ifndef TARGET_OS_WINDOWS
+    const int fd = open_u(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT,
+                          0666);
+    if (fd != -1)
+    {
+        ok = write(fd, line.data(), line.size()) == (ssize_t) line.size();
+        ok = !close(fd) && ok;
+    }
+#else
+    if (FILE *fp = lk_open("a", filename))
+    {
+        ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+        lk_close(fp);
+    }
+#endif
 
-    // we're at the end of the file, seek back to beginning.
-    fseek(scores, 0, SEEK_SET);
+    if (ok)
+        _xlog_count_write(line.size());
+    return ok;
+}
 
-    // read highscore file, inserting new entry at appropriate point,
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
+// New scores are only ever appended to the scores log, so that games ending
+// at the same time don't wait on each other. The scores
+// file proper (still in the old format, for anything else that reads it)
+// is the top of the table as of some point in the log, recorded in the
+// offset file; it's rebuilt once enough has been appended since.
+//
+// So that the log doesn't grow forever, a rebuild that has folded all of it
+// into the scores file retires it and starts the next generation of log.
+// The offset file holds the generation as well as the offset into it.
+struct score_log_pos
+{
+    long generation;
+    long offset;
+};
+
+static string _score_log_name(long generation)
+{
+    // Generation 0 keeps the name logs had before there were generations.
+    if (!generation)
+        return _score_file_name() + ".log";
+    return make_stringf("%s.log.%ld", _score_file_name().c_str(), generation);
+}
+
+static string _score_offset_name()
+{
+    return _score_file_name() + ".offset";
+}
+
+// How many new scores the log can get ahead of the scores file by.
+static const int SCORE_LOG_BACKLOG = 32;
+
+// Insert se into hs_list in order, returning where it went (or -1 if it
+// didn't make the table). Ties go to the newer entry.
+static int _hs_insert(const scorefile_entry &se)
+{
+    int i = 0;
+    while (i < hs_list_size && se.get_score() < hs_list[i]->get_score())
+        ++i;
+
+    if (i >= SCORE_FILE_ENTRIES)
+        return -1;
+
+    if (hs_list_size < SCORE_FILE_ENTRIES)
+        ++hs_list_size;
+    for (int j = hs_list_size - 1; j > i; --j)
+        hs_list[j] = move(hs_list[j - 1]);
+    hs_list[i].reset(new scorefile_entry(se));
+    return i;
+}
+
+// Read one whole line, however long, into line. Returns false at the end of
+// the file, including when the last line has no newline yet; line then holds
+// whatever there is of it.
+static bool _hs_read_line(FILE *f, string &line)
+{
+    line.clear();
+    char buf[1300];
+    while (fgets(buf, sizeof buf, f))
     {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
+        line += buf;
+        if (line.back() == '\n')
+            return true;
+    }
+    return false;
+}
+
+// An offset file with just an offset in it is from before generations.
+static score_log_pos _hs_read_offset()
+{
+    score_log_pos pos = { 0, 0 };
+    FILE *f = fopen_u(_score_offset_name().c_str(), "r");
+    if (f)
+    {
+        long first, second;
+        const int got = fscanf(f, "%ld %ld", &first, &second);
+        if (got == 2)
+            pos = { first, second };
+        else if (got == 1)
+            pos.offset = first;
+        fclose(f);
+    }
+    return pos;
+}
+
+// Append line to the current generation of the scores log. Appenders share
+// a lock on the log while they write, which doesn't hold them up against
+// each other; it only keeps them out while a rebuild retires the log. Once
+// they have the lock they make sure the log is still current, and move on
+// to the next one if it isn't.
+static bool _hs_log_append(const string &line)
+{
+    for (;;)
+    {
+        const long generation = _hs_read_offset().generation;
+        const string name = _score_log_name(generation);
+        bool ok = false;
+#ifndef TARGET_OS_WINDOWS
+        // A shared fcntl() lock needs the file open for reading.
+        const int fd = open_u(name.c_str(), O_RDWR | O_APPEND | O_CREAT,
+                              0666);
+        if (fd == -1)
+            return false;
+        if (!lock_file(fd, false, true))
+        {
+            close(fd);
+            return false;
+        }
+        if (_hs_read_offset().generation != generation)
+        {
+            // Retired while we waited, or (re)created by opening it after
+            // it was retired.
+            unlink_u(name.c_str());
+            close(fd);
+            continue;
+        }
+        ok = write(fd, line.data(), line.size()) == (ssize_t) line.size();
+        ok = !close(fd) && ok;
+#else
+        FILE *fp = fopen_u(name.c_str(), "a");
+        if (!fp)
+            return false;
+        if (!lock_file(fileno(fp), true, true))
+        {
+            fclose(fp);
+            return false;
+        }
+        if (_hs_read_offset().generation != generation)
+        {
+            fclose(fp);
+            unlink_u(name.c_str());
+            continue;
+        }
+        ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+        ok = !fclose(fp) && ok;
+#endif
+        if (ok)
+            _xlog_count_write(line.size());
+        return ok;
+    }
+}
 
-        // compare points..
-        if (!inserted && ne.get_score() >= hs_list[i]->get_score())
+// Read the score table into hs_list: the scores file, plus whatever has
+// been logged since. None of this needs a lock, since the scores file and
+// offset file are only ever replaced whole, and the log is only appended
+// to. Returns how many log entries the scores file is behind by; if
+// log_end is given, it's set to the end of the last complete one. The log
+// is read through log if given, which is left open; that's only for
+// rebuilds, during which the generation can't change.
+static int _hs_read_table(score_log_pos *log_end = nullptr,
+                          FILE *log = nullptr)
+{
+    for (;;)
+    {
+        // Read the offset first: if the scores file is rebuilt in between,
+        // we may see some of the log twice, but never miss any of it.
+        score_log_pos pos = _hs_read_offset();
+
+        hs_list_size = 0;
+        hs_list_initalized = true;
+        set<string> seen;
+        if (FILE *scores = fopen_u(_score_file_name().c_str(), "r"))
         {
-            newest_entry = i;           // for later printing
-            inserted = true;
-            // copy read entry to i+1th position
-            // Fixed a nasty overflow bug here -- Sharp
-            if (i+1 < SCORE_FILE_ENTRIES)
+            for (; hs_list_size < SCORE_FILE_ENTRIES; ++hs_list_size)
             {
-                hs_list[i + 1] = move(hs_list[i]);
-                hs_list[i].reset(new scorefile_entry(ne));
-                i++;
+                hs_list[hs_list_size].reset(new scorefile_entry);
+                if (!_hs_read(scores, *hs_list[hs_list_size]))
+                    break;
+                seen.insert(hs_list[hs_list_size]->raw_string());
             }
-            else
-                *hs_list[i] = ne; // copy new entry to current position
+            fclose(scores);
         }
+
+        int backlog = 0;
+        const bool own_log = !log;
+        FILE *from = own_log
+            ? fopen_u(_score_log_name(pos.generation).c_str(), "r")
+            : log;
+        if (from)
+        {
+            fseek(from, pos.offset, SEEK_SET);
+
+            // Stop at a line that's still being written.
+            string line;
+            while (_hs_read_line(from, line))
+            {
+                pos.offset = ftell(from);
+                ++backlog;
+
+                scorefile_entry se;
+                if (se.parse(line) && !seen.count(line))
+                    _hs_insert(se);
+            }
+            if (own_log)
+                fclose(from);
+        }
+
+        // If the log was retired meanwhile, what we read of it may stop
+        // short of what went into the scores file in its place, and newer
+        // scores are in the next log: start again.
+        if (own_log && _hs_read_offset().generation != pos.generation)
+            continue;
+
+        if (log_end)
+            *log_end = pos;
+        return backlog;
     }
+}
 
-    // special case: lowest score, with room
-    if (!inserted && i < SCORE_FILE_ENTRIES)
+static bool _hs_replace_file(const string &filename, const string &contents)
+{
+    const string tmp = filename + ".tmp";
+    FILE *f = fopen_replace(tmp.c_str());
+    if (!f)
+        return false;
+
+    const bool ok = fwrite(contents.data(), 1, contents.size(), f)
+                        == contents.size();
+    if (fclose(f) || !ok || rename_u(tmp.c_str(), filename.c_str()))
     {
-        newest_entry = i;
-        inserted = true;
-        // copy new entry
-        hs_list[i].reset(new scorefile_entry(ne));
-        i++;
+        unlink_u(tmp.c_str());
+        return false;
     }
+    return true;
+}
 
-    hs_list_size = i;
-    hs_list_initalized = true;
+static bool _hs_write_offset(const score_log_pos &pos)
+{
+    return _hs_replace_file(_score_offset_name(),
+                            make_stringf("%ld %ld\n", pos.generation,
+                                         pos.offset));
+}
+
+// Bring the scores file up to date with the log, unless someone else is
+// already doing so.
+static void _hs_rebuild_table()
+{
+    FILE *lock = fopen_u((_score_file_name() + ".lock").c_str(), "a");
+    if (!lock)
+        return;
 
-    // If we've still not inserted it, it's not a highscore.
-    if (!inserted)
+    if (lock_file(fileno(lock), true, false))
     {
-        _hs_close(scores);
-        return -1;
+        // If no game is appending to the log just now, keep them out until
+        // all of it is in the scores file and the log has been retired.
+        // Otherwise retiring it waits for the next rebuild. The log has to
+        // be read through this same handle: closing any other one would
+        // drop the lock.
+        const string log_name =
+            _score_log_name(_hs_read_offset().generation);
+        FILE *log = fopen_u(log_name.c_str(), "r+");
+        const bool retire = log && lock_file(fileno(log), true, false);
+
+        score_log_pos log_end;
+        _hs_read_table(&log_end, retire ? log : nullptr);
+
+        string table;
+        for (int i = 0; i < hs_list_size; ++i)
+            table += hs_list[i]->raw_string();
+
+        // The scores file goes first, so that readers that catch us in
+        // between see too much of the log rather than too little. Readers
+        // that started on the retired log notice the new generation when
+        // they're done and read everything again.
+        if (_hs_replace_file(_score_file_name(), table))
+        {
+            score_log_pos next = log_end;
+            if (retire && !fseek(log, 0, SEEK_END)
+                && ftell(log) == log_end.offset)
+            {
+                next = { log_end.generation + 1, 0 };
+            }
+            if (_hs_write_offset(next)
+                && next.generation != log_end.generation)
+            {
+                unlink_u(log_name.c_str());
+            }
+        }
+        if (log)
+            fclose(log);
+        unlock_file(fileno(lock));
     }
+    fclose(lock);
+}
+
+int hiscores_new_entry(const scorefile_entry &ne)
+{
+    unwind_bool score_update(crawl_state.updating_scores, true);
 
-    // The old code closed and reopened the score file, leading to a
-    // race condition where one Crawl process could overwrite the
-    // other's highscore. Now we truncate and rewrite the file without
-    // closing it.
-    if (ftruncate(fileno(scores), 0))
-        end(1, true, "unable to truncate scorefile");
+    const string line = ne.raw_string();
+    if (!_hs_log_append(line))
+        end(1, true, "failed to open score file for writing");
 
-    rewind(scores);
+    const int backlog = _hs_read_table();
 
-    // write scorefile entries.
-    for (i = 0; i < hs_list_size; i++)
+    // Find where we ended up, for later printing.
+    int newest_entry = -1;
+    for (int i = 0; i < hs_list_size; i++)
     {
-        _hs_write(scores, *hs_list[i]);
-
-        // Leave in memory. Does this anyway if !inserted.
-        // Can write cleanup function if nessicary??
-        // hs_list[i].reset(nullptr);
+        if (hs_list[i]->raw_string() == line)
+        {
+            newest_entry = i;
+            break;
+        }
     }
 
-    // close scorefile.
-    _hs_close(scores);
+    if (backlog >= SCORE_LOG_BACKLOG)
+        _hs_rebuild_table();
+
     return newest_entry;
 }
 
@@ -190,21 +465,8 @@ void logfile_new_entry(const scorefile_entry &ne)
 {
     unwind_bool logfile_update(crawl_state.updating_scores, true);
 
-    FILE *logfile;
-    scorefile_entry le = ne;
-
-    // open logfile (appending) -- nullptr *is* fatal here.
-    logfile = _hs_open("a", _log_file_name());
-    if (logfile == nullptr)
-    {
+    if (!_xlog_append(_log_file_name(), ne.raw_string()))
         mprf(MSGCH_ERROR, "ERROR: failure writing to the logfile.");
-        return;
-    }
-
-    _hs_write(logfile, le);
-
-    // close logfile.
-    _hs_close(logfile);
 }
 
 template <class t_printf>
@@ -231,27 +493,7 @@ static void _hiscores_print_entry(const scorefile_entry &se,
 // Reads hiscores file to memory
 void hiscores_read_to_memory()
 {
-    FILE *scores;
-    int i;
-
-    // open highscore file (reading)
-    scores = _hs_open("r", _score_file_name());
-    if (scores == nullptr)
-        return;
-
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    hs_list_size = i;
-    hs_list_initalized = true;
-
-    //close off
-    _hs_close(scores);
+    _hs_read_table();
 }
 
 // Writes all entries in the scorefile to stdout in human-readable form.
@@ -259,27 +501,41 @@ void hiscores_print_all(int display_count, int format)
 {
     unwind_bool scorefile_display(crawl_state.updating_scores, true);
 
-    FILE *scores = _hs_open("r", _score_file_name());
-    if (scores == nullptr)
+    // Reading a scores file from standard input.
+    if (_score_file_name() == "-")
+    {
+        for (int entry = 0; display_count <= 0 || entry < display_count;
+             ++entry)
+        {
+            scorefile_entry se;
+            if (!_hs_read(stdin, se))
+                break;
+
+            if (format == -1)
+                printf("%s", se.raw_string().c_str());
+            else
+                _hiscores_print_entry(se, entry, format, printf);
+        }
+        return;
+    }
+
+    _hs_read_table();
+    if (!hs_list_size)
     {
         // will only happen from command line
         puts("No scores.");
         return;
     }
 
-    for (int entry = 0; display_count <= 0 || entry < display_count; ++entry)
+    for (int entry = 0; entry < hs_list_size
+                        && (display_count <= 0 || entry < display_count);
+         ++entry)
     {
-        scorefile_entry se;
-        if (!_hs_read(scores, se))
-            break;
-
         if (format == -1)
-            printf("%s", se.raw_string().c_str());
+            printf("%s", hs_list[entry]->raw_string().c_str());
         else
-            _hiscores_print_entry(se, entry, format, printf);
+            _hiscores_print_entry(*hs_list[entry], entry, format, printf);
     }
-
-    _hs_close(scores);
 }
 
 // Displays high scores using curses. For output to the console, use
@@ -456,23 +712,9 @@ UIHiscoresMenu::UIHiscoresMenu()
 
 void UIHiscoresMenu::_construct_hiscore_table()
 {
-    FILE *scores = _hs_open("r", _score_file_name());
-
-    if (scores == nullptr)
-        return;
-
-    int i;
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
+    _hs_read_table();
 
-    _hs_close(scores);
-
-    for (int j=0; j<i; j++)
+    for (int j = 0; j < hs_list_size; j++)
         _add_hiscore_row(*hs_list[j], j);
 }
 
@@ -591,33 +833,18 @@ string hiscores_format_single_long(const scorefile_entry &se, bool verbose)
 // BEGIN private functions
 // --------------------------------------------------------------------------
 
-static FILE *_hs_open(const char *mode, const string &scores)
-{
-    // allow reading from standard input
-    if (scores == "-")
-        return stdin;
-
-    return lk_open(mode, scores);
-}
-
-static void _hs_close(FILE *handle)
-{
-    lk_close(handle);
-}
-
 static bool _hs_read(FILE *scores, scorefile_entry &dest)
 {
-    char inbuf[1300];
     if (!scores || feof(scores))
         return false;
 
-    memset(inbuf, 0, sizeof inbuf);
     dest.reset();
 
-    if (!fgets(inbuf, sizeof inbuf, scores))
+    string line;
+    if (!_hs_read_line(scores, line) && line.empty())
         return false;
 
-    return dest.parse(inbuf);
+    return dest.parse(line);
 }
 
 static int _val_char(char digit)
@@ -645,11 +872,6 @@ static time_t _parse_time(const string &st)
     return mktime(&date);
 }
 
-static void _hs_write(FILE *scores, scorefile_entry &se)
-{
-    fprintf(scores, "%s", se.raw_string().c_str());
-}
-
 static const char *kill_method_names[] =
 {
     "mon", "pois", "cloud", "beam", "lava", "water",
@@ -2887,8 +3109,6 @@ void xlog_fields::init(const string &line)
         fields.emplace_back(field.substr(0, st),
                             _xlog_unescape(field.substr(st + 1)));
     }
-
-    map_fields();
 }
 
 void xlog_fields::add_field(const string &key, const char *format, ...)
@@ -2899,11 +3119,15 @@ void xlog_fields::add_field(const string &key, const char *format, ...)
     va_end(args);
 
     fields.emplace_back(key, buf);
-    fieldmap[key] = buf;
+    // Only keep the map up to date once someone's looked anything up.
+    if (!fieldmap.empty())
+        fieldmap[key] = buf;
 }
 
 string xlog_fields::str_field(const string &s) const
 {
+    if (fieldmap.empty())
+        map_fields();
     return lookup(fieldmap, s, "");
 }
 
@@ -2923,6 +3147,7 @@ void xlog_fields::map_fields() const
 string xlog_fields::xlog_line() const
 {
     string line;
+    line.reserve(1024);
     for (const pair<string, string> &f : fields)
     {
         // Don't write empty fields.
@@ -2991,12 +3216,7 @@ void mark_milestone(const string &type, const string &milestone,
                                     : se.get_death_time()).c_str());
     xl.add_field("type", "%s", type.c_str());
     xl.add_field("milestone", "%s", milestone.c_str());
-    const string xlog_line = xl.xlog_line();
-    if (FILE *fp = lk_open("a", milestone_file))
-    {
-        fprintf(fp, "%s\n", xlog_line.c_str());
-        lk_close(fp);
-    }
+    _xlog_append(milestone_file, xl.xlog_line() + "\n");
 #else
     UNUSED(type, milestone, origin_level, milestone_time);
 #endif // DGL_MILESTONES
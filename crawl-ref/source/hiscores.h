@@ -27,6 +27,10 @@ string hiscores_format_single_long(const scorefile_entry &se,
 void mark_milestone(const string &type, const string &milestone,
                     const string &origin_level = "", time_t t = 0);
 
+// How many records (and bytes) this game has added to the logfile,
+// milestones and scores log.
+void xlog_write_stats(unsigned long &records, unsigned long &bytes);
+
 #ifdef DGL_WHEREIS
 string xlog_status_line();
 #endif
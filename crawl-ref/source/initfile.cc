@@ -383,6 +383,7 @@ const vector<GameOption*> game_options::build_options_list()
         new BoolGameOption(SIMPLE_NAME(tile_level_map_hide_messages), true),
         new BoolGameOption(SIMPLE_NAME(tile_level_map_hide_sidebar), false),
         new BoolGameOption(SIMPLE_NAME(tile_web_mouse_control), true),
+        new BoolGameOption(SIMPLE_NAME(tile_web_send_stats), false),
         new StringGameOption(SIMPLE_NAME(tile_font_crt_family), "monospace"),
         new StringGameOption(SIMPLE_NAME(tile_font_msg_family), "monospace"),
         new StringGameOption(SIMPLE_NAME(tile_font_stat_family), "monospace"),
@@ -3922,6 +3923,9 @@ enum commandline_option_type
     CLO_ITERATIONS,
     CLO_FORCE_MAP,
     CLO_ARENA,
+    CLO_ARENA_BATCH,
+    CLO_FSIM_BATCH,
+    CLO_FSIM_JOBS,
     CLO_DUMP_MAPS,
     CLO_TEST,
     CLO_SCRIPT,
@@ -3960,7 +3964,8 @@ static const char *cmd_ops[] =
 {
     "scores", "name", "species", "background", "dir", "rc", "rcdir", "tscores",
     "vscores", "scorefile", "morgue", "macro", "mapstat", "dump-disconnect",
-    "objstat", "iters", "force-map", "arena", "dump-maps", "test", "script",
+    "objstat", "iters", "force-map", "arena", "arena-batch", "fsim-batch",
+    "fsim-jobs", "dump-maps", "test", "script",
     "builddb", "help", "version", "seed", "pregen", "save-version", "sprint",
     "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
     "print-charset", "tutorial", "wizard", "explore", "no-save", "gdb",
@@ -4871,6 +4876,39 @@ bool parse_args(int argc, char **argv, bool rc_only)
             }
             break;
 
+        case CLO_ARENA_BATCH:
+            if (!next_is_param)
+                end(1, false, "File name required for -%s\n", arg);
+            if (!rc_only)
+            {
+                crawl_state.arena_batch = next_arg;
+                Options.restart_after_game = MB_FALSE;
+            }
+            nextUsed = true;
+            break;
+
+        case CLO_FSIM_BATCH:
+#ifdef WIZARD
+            if (!next_is_param)
+                end(1, false, "File name required for -%s\n", arg);
+            if (!rc_only)
+            {
+                crawl_state.fsim_batch = next_arg;
+                Options.restart_after_game = MB_FALSE;
+            }
+            nextUsed = true;
+#else
+            end(1, false, "fsim is available only in WIZARD builds.\n");
+#endif
+            break;
+
+        case CLO_FSIM_JOBS:
+            if (!next_is_param)
+                end(1, false, "Number of processes required for -%s\n", arg);
+            crawl_state.fsim_jobs = atoi(next_arg);
+            nextUsed = true;
+            break;
+
         case CLO_DUMP_MAPS:
             crawl_state.dump_maps = true;
             break;
@@ -39,6 +39,7 @@
 #include "english.h"
 #include "env.h"
 #include "food.h"
+#include "free-slots.h"
 #include "god-passive.h"
 #include "god-prayer.h"
 #include "hints.h"
@@ -501,6 +502,27 @@ void init_item(int item)
     mitm[item].clear();
 }
 
+// The mitm slots known to be free; see free-slots.h.
+static free_slot_list<MAX_ITEMS> _free_items;
+
+static bool _item_slot_free(int item)
+{
+    return !mitm[item].defined();
+}
+
+// Called whenever mitm has been replaced wholesale (a new or newly loaded
+// level).
+void rebuild_item_free_list()
+{
+    _free_items.rebuild(_item_slot_free);
+}
+
+// Called when an mitm slot has been emptied without destroy_item().
+void item_slot_freed(int item)
+{
+    _free_items.release(item);
+}
+
 // Returns an unused mitm slot, or NON_ITEM if none available.
 // The reserve is the number of item slots to not check.
 // Items may be culled if a reserve <= 10 is specified.
@@ -511,13 +533,9 @@ int get_mitm_slot(int reserve)
     if (crawl_state.game_is_arena())
         reserve = 0;
 
-    int item = NON_ITEM;
-
-    for (item = 0; item < (MAX_ITEMS - reserve); item++)
-        if (!mitm[item].defined())
-            break;
+    int item = _free_items.take(MAX_ITEMS - reserve, _item_slot_free);
 
-    if (item >= MAX_ITEMS - reserve)
+    if (item == -1)
     {
         if (crawl_state.game_is_arena())
         {
@@ -635,6 +653,7 @@ void unlink_item(int dest)
     mitm[dest].link      = NON_ITEM;
     mitm[dest].pos.reset();
     mitm[dest].props.clear();
+    _free_items.release(dest);
 
     // Look through all items for links to this item.
     for (auto &item : mitm)
@@ -686,6 +705,8 @@ void destroy_item(item_def &item, bool never_created)
     }
 
     item.clear();
+    // Items outside mitm have an index out of range, which is ignored.
+    _free_items.release(item.index());
 }
 
 void destroy_item(int dest, bool never_created)
@@ -693,9 +714,17 @@ void destroy_item(int dest, bool never_created)
     // Don't destroy non-items, but this function may be called upon
     // to remove items reduced to zero quantity, so we allow "invalid"
     // objects in.
-    if (dest == NON_ITEM || !mitm[dest].defined())
+    if (dest == NON_ITEM)
         return;
 
+    // A slot handed out by get_mitm_slot() but never filled in (e.g. a
+    // cancelled wizard item) still has to go back on the free list.
+    if (!mitm[dest].defined())
+    {
+        _free_items.release(dest);
+        return;
+    }
+
     unlink_item(dest);
     destroy_item(mitm[dest], never_created);
 }
@@ -78,6 +78,8 @@ void link_items();
 void fix_item_coordinates();
 
 int get_mitm_slot(int reserve = 50);
+void rebuild_item_free_list();
+void item_slot_freed(int item);
 
 void unlink_item(int dest);
 void destroy_item(item_def &item, bool never_created = false);
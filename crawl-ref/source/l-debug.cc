@@ -5,7 +5,10 @@
 
 #include "l-libs.h"
 
+#include <chrono>
+
 #include "act-iter.h"
+#include "beam.h"
 #include "branch.h"
 #include "chardump.h"
 #include "cluautil.h"
@@ -13,11 +16,15 @@
 #include "dbg-util.h"
 #include "dungeon.h"
 #include "files.h"
+#include "free-slots.h"
 #include "god-wrath.h"
+#include "hiscores.h"
 #include "los.h"
+#include "maps.h"
 #include "message.h"
 #include "mon-act.h"
 #include "mon-death.h"
+#include "mon-pick.h"
 #include "mon-poly.h"
 #include "ng-setup.h"
 #include "religion.h"
@@ -25,6 +32,9 @@
 #include "state.h"
 #include "stringutil.h"
 #include "tileview.h"
+#include "timed-effects.h"
+#include "travel.h"
+#include "ui.h"
 #include "view.h"
 #include "wiz-dgn.h"
 
@@ -348,6 +358,229 @@ LUAFN(debug_viewwindow)
 
 LUAWRAP(debug_seen_monsters_react, seen_monsters_react())
 
+// Usage: apply_enchantments(<rounds>)
+// Runs monster::apply_enchantments() on every monster on the level <rounds>
+// times (default 1), without the rest of the monster turn. Meant for timing
+// the enchantment bookkeeping; see scripts/bench-enchantments.lua.
+LUAFN(debug_apply_enchantments)
+{
+    const int rounds = lua_isnoneornil(ls, 1) ? 1 : luaL_safe_checkint(ls, 1);
+    for (int i = 0; i < rounds; ++i)
+        for (monster_iterator mi; mi; ++mi)
+            mi->apply_enchantments();
+    return 0;
+}
+
+// Usage: update_level(<aut>)
+// Runs the catch-up done when the player returns to a level after <aut>
+// away, on the current level. See scripts/bench-catchup.lua.
+LUAFN(debug_update_level)
+{
+    update_level(luaL_safe_checkint(ls, 1));
+    return 0;
+}
+
+// Usage: tracer_stats(<this_turn>)
+// Returns the number of beam tracers actually fired and answered from the
+// monster tracer cache, for the last complete turn (or so far this turn, if
+// <this_turn> is true).
+LUAFN(debug_tracer_stats)
+{
+    const tracer_stats &stats = get_tracer_stats(lua_toboolean(ls, 1));
+    lua_pushnumber(ls, stats.fired);
+    lua_pushnumber(ls, stats.reused);
+    return 2;
+}
+
+// Usage: check_stair_distances()
+// Updates interlevel travel's idea of the current level and returns whether
+// its stair distances agree with those from one flood per stair.
+LUAFN(debug_check_stair_distances)
+{
+    PLUARET(boolean, travel_cache.get_level_info(level_id::current())
+                         .check_stair_distances());
+}
+
+// Usage: check_zone_labels()
+// Returns whether labelling the current level's disconnected zones in one
+// go agrees with flood-filling them one at a time.
+LUAFN(debug_check_zone_labels)
+{
+    PLUARET(boolean, dgn_check_zone_labels());
+}
+
+// Usage: use_pick_tables(<bool>)
+// Turns the cached monster pick tables on or off, to check that they pick
+// the same monsters as working the rarities out every time.
+LUAFN(debug_use_pick_tables)
+{
+    monster_picker::use_tables = lua_toboolean(ls, 1);
+    return 0;
+}
+
+// Usage: check_free_slots(<bool>)
+// Turns checking of the item and monster free lists on or off: while it's
+// on, every slot they hand out is compared with the lowest free slot found
+// by walking the table. Returns how many times they differed since checking
+// was last turned on.
+LUAFN(debug_check_free_slots)
+{
+    free_slot_checks &checks = free_slot_check_state();
+    const int mismatches = checks.mismatches;
+    checks.enabled = lua_toboolean(ls, 1);
+    if (checks.enabled)
+        checks.mismatches = 0;
+    PLUARET(number, mismatches);
+}
+
+// Usage: new_score_entry()
+// Adds the character to the score table as if they had just quit, and
+// returns their place in it (or -1 if they didn't make it).
+LUAFN(debug_new_score_entry)
+{
+    scorefile_entry se(0, MID_NOBODY, KILLED_BY_QUITTING, nullptr);
+    PLUARET(number, hiscores_new_entry(se));
+}
+
+// Usage: xlog_stats()
+// Returns how many records and bytes this game has written to the logfile,
+// milestones and scores log.
+LUAFN(debug_xlog_stats)
+{
+    unsigned long records, bytes;
+    xlog_write_stats(records, bytes);
+    lua_pushnumber(ls, records);
+    lua_pushnumber(ls, bytes);
+    return 2;
+}
+
+static void _set_number_field(lua_State *ls, const char *name, double value)
+{
+    lua_pushstring(ls, name);
+    lua_pushnumber(ls, value);
+    lua_settable(ls, -3);
+}
+
+// Usage: levelgen_timings()
+// Returns a table of what the level builder has done since the timings were
+// last reset: levels, vetoes, total and each phase's time in milliseconds.
+// See scripts/bench-levelgen.lua.
+LUAFN(debug_levelgen_timings)
+{
+    const levelgen_timings &timings = dgn_builder_timings;
+    lua_newtable(ls);
+    _set_number_field(ls, "levels", timings.levels);
+    _set_number_field(ls, "vetoes", timings.vetoes);
+    _set_number_field(ls, "total", timings.total * 1000);
+    for (int i = 0; i < NUM_LEVELGEN_PHASES; ++i)
+    {
+        _set_number_field(ls,
+                          levelgen_phase_name(static_cast<levelgen_phase>(i)),
+                          timings.phase[i] * 1000);
+    }
+    return 1;
+}
+
+// Usage: reset_levelgen_timings()
+LUAFN(debug_reset_levelgen_timings)
+{
+    UNUSED(ls);
+    dgn_reset_builder_timings();
+    return 0;
+}
+
+// Usage: reread_maps()
+// Throws away every map definition and reads them all in again, as a game
+// does at startup. See scripts/bench-lua-alloc.lua.
+LUAFN(debug_reread_maps)
+{
+    UNUSED(ls);
+    reread_maps();
+    return 0;
+}
+
+// Usage: lua_alloc_stats([<clua>])
+// Returns a table of the dungeon Lua state's allocation counts, or the user
+// one's if <clua> is true: allocs, reallocs, frees, pooled (how many of those
+// the pool served), and in_use, peak and reserved in bytes. All zero in
+// builds where Lua can't take a custom allocator.
+LUAFN(debug_lua_alloc_stats)
+{
+    const CLua &vm = lua_toboolean(ls, 1) ? clua : dlua;
+    const lua_alloc_stats &stats = vm.allocator.stats();
+    lua_newtable(ls);
+    _set_number_field(ls, "allocs", stats.allocs);
+    _set_number_field(ls, "reallocs", stats.reallocs);
+    _set_number_field(ls, "frees", stats.frees);
+    _set_number_field(ls, "pooled", stats.pooled);
+    _set_number_field(ls, "in_use", stats.in_use);
+    _set_number_field(ls, "peak", stats.peak);
+    _set_number_field(ls, "reserved", stats.reserved);
+    return 1;
+}
+
+// Usage: time_ui_layout(text, passes)
+// Lays out a description popup holding text (with formatting tags) passes
+// times, alternating between a few screen widths as a resize would, and
+// returns the time taken in milliseconds. Nothing is drawn.
+// See scripts/bench-ui-layout.lua.
+LUAFN(debug_time_ui_layout)
+{
+    const string text = luaL_checkstring(ls, 1);
+    const int passes = luaL_safe_checkint(ls, 2);
+
+    auto vbox = make_shared<ui::Box>(ui::Widget::VERT);
+    auto title_hbox = make_shared<ui::Box>(ui::Widget::HORZ);
+    title_hbox->add_child(make_shared<ui::Text>("A description"));
+    title_hbox->set_margin_for_sdl(0, 0, 20, 0);
+    title_hbox->set_margin_for_crt(0, 0, 1, 0);
+    vbox->add_child(move(title_hbox));
+
+    auto body = make_shared<ui::Text>(formatted_string::parse_string(text));
+    body->set_wrap_text(true);
+    auto scroller = make_shared<ui::Scroller>();
+    scroller->set_child(body);
+    vbox->add_child(move(scroller));
+    auto popup = make_shared<ui::Popup>(vbox);
+
+#ifdef USE_TILE_LOCAL
+    const int widths[] = { 600, 800, 1000 };
+    const int height = 700;
+#else
+    const int widths[] = { 60, 80, 100 };
+    const int height = 24;
+#endif
+
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < passes; ++i)
+    {
+        const int width = widths[i % ARRAYSZ(widths)];
+        popup->get_preferred_size(ui::Widget::HORZ, -1);
+        popup->get_preferred_size(ui::Widget::VERT, width);
+        popup->allocate_region({0, 0, width, height});
+    }
+    const chrono::duration<double, milli> elapsed =
+        chrono::steady_clock::now() - start;
+
+    lua_pushnumber(ls, elapsed.count());
+    return 1;
+}
+
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+// Usage: console_stats()
+// Returns the running totals of view cells drawn and of those actually sent
+// to curses because they had changed; sample it once a turn to see how much
+// terminal output the view costs.
+LUAFN(debug_console_stats)
+{
+    unsigned long drawn, sent;
+    console_view_stats(drawn, sent);
+    lua_pushnumber(ls, drawn);
+    lua_pushnumber(ls, sent);
+    return 2;
+}
+#endif
+
 static const char* disablements[] =
 {
     "spawns",
@@ -459,6 +692,23 @@ const struct luaL_reg debug_dlib[] =
 { "check_uniques", debug_check_uniques },
 { "viewwindow", debug_viewwindow },
 { "seen_monsters_react", debug_seen_monsters_react },
+{ "apply_enchantments", debug_apply_enchantments },
+{ "update_level", debug_update_level },
+{ "tracer_stats", debug_tracer_stats },
+{ "check_stair_distances", debug_check_stair_distances },
+{ "check_zone_labels", debug_check_zone_labels },
+{ "use_pick_tables", debug_use_pick_tables },
+{ "check_free_slots", debug_check_free_slots },
+{ "new_score_entry", debug_new_score_entry },
+{ "xlog_stats", debug_xlog_stats },
+{ "levelgen_timings", debug_levelgen_timings },
+{ "reset_levelgen_timings", debug_reset_levelgen_timings },
+{ "time_ui_layout", debug_time_ui_layout },
+{ "reread_maps", debug_reread_maps },
+{ "lua_alloc_stats", debug_lua_alloc_stats },
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+{ "console_stats", debug_console_stats },
+#endif
 { "disable", debug_disable },
 { "cpp_assert", debug_cpp_assert },
 { "reset_rng", debug_reset_rng },
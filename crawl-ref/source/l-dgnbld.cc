@@ -125,7 +125,7 @@ static bool _coords(lua_State *ls, map_lines &lines,
 }
 
 // Check if a given coordiante is valid for lines.
-static bool _valid_coord(lua_State *ls, map_lines &lines, int x, int y, bool error = true)
+static bool _valid_coord(lua_State *ls, const map_lines &lines, int x, int y, bool error = true)
 {
     if (x < 0 || x >= lines.width())
     {
@@ -164,7 +164,7 @@ static void _border_area(map_lines &lines, int x1, int y1, int x2, int y2, char
 }
 
 // Does what count_passable_neighbors does, but in C++ form.
-static int _count_passable_neighbors(lua_State *ls, map_lines &lines, int x,
+static int _count_passable_neighbors(lua_State *ls, const map_lines &lines, int x,
                                      int y, const char *passable = traversable_glyphs)
 {
     coord_def tl(x, y);
@@ -639,28 +639,7 @@ LUAFN(dgn_fill_disconnected)
     coord_def tl(x1, y1);
     coord_def br(x2, y2);
 
-    travel_distance_grid_t tpd;
-    memset(tpd, 0, sizeof(tpd));
-
-    int nzones = 0;
-    for (rectangle_iterator ri(tl, br); ri; ++ri)
-    {
-        const coord_def c = *ri;
-        if (tpd[c.x][c.y] || passable && !strchr(passable, lines(c)))
-            continue;
-
-        if (lines.fill_zone(tpd, c, tl, br, ++nzones, wanted, passable))
-            continue;
-
-        // If wanted wasn't found, fill every passable square that
-        // we just found with the 'fill' glyph.
-        for (rectangle_iterator f(tl, br); f; ++f)
-        {
-            const coord_def fc = *f;
-            if (tpd[fc.x][fc.y] == nzones)
-                lines(fc) = fill;
-        }
-    }
+    lines.fill_disconnected(tl, br, fill, wanted, passable);
 
     return 0;
 }
@@ -676,7 +655,7 @@ LUAFN(dgn_is_passable_coord)
     if (!_valid_coord(ls, lines, x, y))
         return 0;
 
-    if (strchr(passable, lines(x, y)))
+    if (strchr(passable, lines.glyph(x, y)))
         lua_pushboolean(ls, true);
     else
         lua_pushboolean(ls, false);
@@ -699,17 +678,23 @@ LUAFN(dgn_find_in_area)
 
     TABLE_STR(ls, find, "x");
 
-    int x, y;
+    if (lines.count_feature_in_box(coord_def(x1, y1), coord_def(x2, y2),
+                                   find))
+    {
+        lua_pushboolean(ls, true);
+        return 1;
+    }
 
-    for (x = x1; x <= x2; x++)
-        for (y = y1; y <= y2; y++)
-            if (strchr(find, lines(x, y))
-                || (find_vault && (env.level_map_mask(coord_def(x,y))
-                                   & MMT_VAULT)))
-            {
-                lua_pushboolean(ls, true);
-                return 1;
-            }
+    if (find_vault)
+    {
+        for (int x = x1; x <= x2; x++)
+            for (int y = y1; y <= y2; y++)
+                if (env.level_map_mask(coord_def(x,y)) & MMT_VAULT)
+                {
+                    lua_pushboolean(ls, true);
+                    return 1;
+                }
+    }
 
     lua_pushboolean(ls, false);
     return 1;
@@ -8,6 +8,7 @@
 #include "files.h"
 #include "libutil.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "tags.h"
 
 //
@@ -200,6 +201,26 @@ LUAFN(_file_writefile)
     return 1;
 }
 
+// Usage: readfile(<filename>)
+// Returns the whole of the file, or nil if it can't be read.
+LUAFN(_file_readfile)
+{
+    const string fname(luaL_checkstring(ls, 1));
+    FILE *f = fopen_u(fname.c_str(), "rb");
+    if (!f)
+        return 0;
+
+    string contents;
+    char buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0)
+        contents.append(buf, got);
+    fclose(f);
+
+    lua_pushlstring(ls, contents.data(), contents.size());
+    return 1;
+}
+
 static const struct luaL_reg file_dlib[] =
 {
     { "marshall",   file_marshall },
@@ -209,6 +230,7 @@ static const struct luaL_reg file_dlib[] =
     { "unmarshall_number", file_unmarshall_number },
     { "unmarshall_string", file_unmarshall_string },
     { "writefile", _file_writefile },
+    { "readfile", _file_readfile },
     { "datadir_files", _file_datadir_files },
     { "datadir_files_recursive", _file_datadir_files_recursive },
     { "minor_version", file_minor_version },
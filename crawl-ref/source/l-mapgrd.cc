@@ -52,13 +52,20 @@ static char* mapgrd_glyph(lua_State *ls, int &col, int &row)
 
 static int mapgrd_col_get(lua_State *ls)
 {
-    int col, row;
-    char *gly = mapgrd_glyph(ls, col, row);
-    if (!gly)
+    mapcolumn *mapc = (mapcolumn *)luaL_checkudata(ls, 1, MAPGRD_COL_METATABLE);
+    if (!mapc)
+        return 0;
+    const int row = luaL_safe_checkint(ls, 2);
+    const int col = mapc->col;
+
+    // Read through a const reference, so that looking doesn't throw away
+    // the map's lookup tables.
+    const map_lines &lines = mapc->map->map;
+    if (row < 0 || col < 0 || col >= lines.width() || row >= lines.height())
         return luaL_error(ls, "Invalid coords: %d, %d", col, row);
 
     char buf[2];
-    buf[0] = *gly;
+    buf[0] = lines(col, row);
     buf[1] = '\0';
 
     lua_pushstring(ls, buf);
@@ -68,7 +75,7 @@ static int mapgrd_col_get(lua_State *ls)
 
 static int mapgrd_col_set(lua_State *ls)
 {
-    int col, row;
+    int col = 0, row = 0;
     char *gly = mapgrd_glyph(ls, col, row);
     if (!gly)
         return luaL_error(ls, "Invalid coords: %d, %d", col, row);
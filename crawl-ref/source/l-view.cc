@@ -13,6 +13,7 @@
 #include "env.h"
 #include "l-defs.h"
 #include "mon-death.h"
+#include "mon-info.h"
 #include "player.h"
 #include "religion.h"
 #include "stringutil.h"
@@ -73,20 +74,15 @@ LUAFN(view_cloud_at)
  * @treturn boolean
  * @function is_safe_square
  */
-LUAFN(view_is_safe_square)
+static bool _is_safe_square(const coord_def &p)
 {
-    PLAYERCOORDS(p, 1, 2)
     if (!map_bounds(p))
-    {
-        PLUARET(boolean, false);
-        return 1;
-    }
+        return false;
     cloud_type c = env.map_knowledge(p).cloud();
     if (c != CLOUD_NONE
         && is_damaging_cloud(c, true, YOU_KILL(env.map_knowledge(p).cloudinfo()->killer)))
     {
-        PLUARET(boolean, false);
-        return 1;
+        return false;
     }
     trap_type t = env.map_knowledge(p).trap();
     if (t != TRAP_UNASSIGNED)
@@ -94,16 +90,17 @@ LUAFN(view_is_safe_square)
         trap_def trap;
         trap.type = t;
         trap.ammo_qty = 1;
-        PLUARET(boolean, trap.is_safe());
-        return 1;
+        return trap.is_safe();
     }
     dungeon_feature_type f = env.map_knowledge(p).feat();
-    if (f != DNGN_UNSEEN && !feat_is_traversable_now(f) || feat_is_runed(f))
-    {
-        PLUARET(boolean, false);
-        return 1;
-    }
-    PLUARET(boolean, true);
+    return !(f != DNGN_UNSEEN && !feat_is_traversable_now(f)
+             || feat_is_runed(f));
+}
+
+LUAFN(view_is_safe_square)
+{
+    PLAYERCOORDS(p, 1, 2)
+    PLUARET(boolean, _is_safe_square(p));
     return 1;
 }
 
@@ -197,6 +194,250 @@ LUAFN(view_cell_see_cell)
     return 1;
 }
 
+/*** A snapshot of everything the player knows about the squares in view.
+ * Bots that look at every square each turn can take one of these instead of
+ * asking about each square separately; its accessors are plain array
+ * lookups. Like the rest of this module, they take player centered
+ * coordinates, and return nil (or false) outside the snapshot.
+ * @type view.snapshot
+ */
+#define VIEW_SNAPSHOT_METATABLE "view.snapshot"
+
+struct view_snapshot_data
+{
+    struct cell
+    {
+        dungeon_feature_type feat = DNGN_UNSEEN;
+        cloud_type cloud = CLOUD_NONE;
+        uint32_t flags = 0;
+        bool safe = false;
+        // Of the monster visible here, if any.
+        mid_t mid = 0;
+        int mons = -1;  // index into monsters
+
+        bool operator==(const cell &other) const
+        {
+            return feat == other.feat && cloud == other.cloud
+                   && flags == other.flags && safe == other.safe
+                   && mid == other.mid;
+        }
+    };
+
+    level_id place;
+    coord_def origin;  // where the player was
+    cell cells[ENV_SHOW_DIAMETER][ENV_SHOW_DIAMETER];
+    vector<monster_info> monsters;
+    // Player centered coordinates of the squares that differ from the
+    // previous snapshot.
+    vector<coord_def> changed;
+
+    const cell *at(const coord_def &s) const
+    {
+        if (!in_show_bounds(s))
+            return nullptr;
+        return &cells[s.x + ENV_SHOW_OFFSET][s.y + ENV_SHOW_OFFSET];
+    }
+};
+
+// The last snapshot taken, to work out what changed since.
+static unique_ptr<view_snapshot_data> _last_snapshot;
+
+static view_snapshot_data *_take_snapshot()
+{
+    view_snapshot_data *snap = new view_snapshot_data;
+    snap->place = level_id::current();
+    snap->origin = you.pos();
+
+    for (int x = -ENV_SHOW_OFFSET; x <= ENV_SHOW_OFFSET; ++x)
+        for (int y = -ENV_SHOW_OFFSET; y <= ENV_SHOW_OFFSET; ++y)
+        {
+            const coord_def p = player2grid(coord_def(x, y));
+            if (!map_bounds(p))
+                continue;
+
+            view_snapshot_data::cell &c =
+                snap->cells[x + ENV_SHOW_OFFSET][y + ENV_SHOW_OFFSET];
+            const map_cell &knowledge = env.map_knowledge(p);
+            c.feat = knowledge.feat();
+            c.cloud = knowledge.cloud();
+            c.flags = knowledge.flags;
+            c.safe = _is_safe_square(p);
+
+            if (!you.see_cell(p) || env.mgrid(p) == NON_MONSTER)
+                continue;
+            const monster* m = &env.mons[env.mgrid(p)];
+            if (!m->visible_to(&you))
+                continue;
+            c.mid = m->mid;
+            c.mons = snap->monsters.size();
+            snap->monsters.emplace_back(m);
+        }
+
+    // Compare by grid position, since the player may have moved; squares
+    // the last snapshot didn't cover count as changed.
+    const view_snapshot_data *last = _last_snapshot.get();
+    const bool comparable = last && last->place == snap->place;
+    for (int x = -ENV_SHOW_OFFSET; x <= ENV_SHOW_OFFSET; ++x)
+        for (int y = -ENV_SHOW_OFFSET; y <= ENV_SHOW_OFFSET; ++y)
+        {
+            const coord_def s(x, y);
+            const view_snapshot_data::cell *before =
+                comparable ? last->at(s + snap->origin - last->origin)
+                           : nullptr;
+            if (!before || !(*before == *snap->at(s)))
+                snap->changed.push_back(s);
+        }
+
+    _last_snapshot.reset(new view_snapshot_data(*snap));
+    _last_snapshot->monsters.clear();
+    _last_snapshot->changed.clear();
+    return snap;
+}
+
+#define SNAPSHOT_CELL(ls, c) \
+    view_snapshot_data *snap = *(view_snapshot_data **) \
+        luaL_checkudata(ls, 1, VIEW_SNAPSHOT_METATABLE); \
+    const view_snapshot_data::cell *c = \
+        snap ? snap->at(coord_def(luaL_safe_checkint(ls, 2), \
+                                  luaL_safe_checkint(ls, 3))) \
+             : nullptr;
+
+/*** What was the feature here?
+ * @tparam int x
+ * @tparam int y
+ * @treturn string feature name, as from view.feature_at
+ * @function feature
+ */
+LUAFN(snapshot_feature)
+{
+    SNAPSHOT_CELL(ls, c)
+    lua_pushstring(ls, dungeon_feature_name(c ? c->feat : DNGN_UNSEEN));
+    return 1;
+}
+
+/*** What kind of cloud (if any) was here?
+ * @tparam int x
+ * @tparam int y
+ * @treturn string|nil cloud name or nil
+ * @function cloud
+ */
+LUAFN(snapshot_cloud)
+{
+    SNAPSHOT_CELL(ls, c)
+    if (!c || c->cloud == CLOUD_NONE)
+        return 0;
+    lua_pushstring(ls, cloud_type_name(c->cloud).c_str());
+    return 1;
+}
+
+/*** Was it safe here, as from view.is_safe_square?
+ * @tparam int x
+ * @tparam int y
+ * @treturn boolean
+ * @function is_safe_square
+ */
+LUAFN(snapshot_is_safe_square)
+{
+    SNAPSHOT_CELL(ls, c)
+    PLUARET(boolean, c && c->safe);
+}
+
+/*** The map knowledge flags of this square.
+ * @tparam int x
+ * @tparam int y
+ * @treturn int the MAP_* flags
+ * @function flags
+ */
+LUAFN(snapshot_flags)
+{
+    SNAPSHOT_CELL(ls, c)
+    PLUARET(number, c ? c->flags : 0);
+}
+
+/*** The id of the monster visible here, if any.
+ * The same monster keeps the same id from snapshot to snapshot.
+ * @tparam int x
+ * @tparam int y
+ * @treturn int|nil
+ * @function monster_id
+ */
+LUAFN(snapshot_monster_id)
+{
+    SNAPSHOT_CELL(ls, c)
+    if (!c || !c->mid)
+        return 0;
+    PLUARET(number, c->mid);
+}
+
+/*** Information about the monster visible here, if any.
+ * @tparam int x
+ * @tparam int y
+ * @treturn monster.info|nil as from monster.get_monster_at
+ * @function monster
+ */
+LUAFN(snapshot_monster)
+{
+    SNAPSHOT_CELL(ls, c)
+    if (!c || c->mons < 0)
+        return 0;
+    lua_push_moninf(ls, &snap->monsters[c->mons]);
+    return 1;
+}
+
+/*** Which squares differ from the snapshot taken before this one?
+ * Squares the previous snapshot didn't cover (because the player moved, or
+ * changed levels) count as changed.
+ * @treturn {int,...} x coordinates
+ * @treturn {int,...} y coordinates
+ * @function changed
+ */
+LUAFN(snapshot_changed)
+{
+    view_snapshot_data *snap = *(view_snapshot_data **)
+        luaL_checkudata(ls, 1, VIEW_SNAPSHOT_METATABLE);
+    if (!snap)
+        return 0;
+
+    const int count = snap->changed.size();
+    lua_createtable(ls, count, 0);
+    lua_createtable(ls, count, 0);
+    for (int i = 0; i < count; ++i)
+    {
+        lua_pushnumber(ls, snap->changed[i].x);
+        lua_rawseti(ls, -3, i + 1);
+        lua_pushnumber(ls, snap->changed[i].y);
+        lua_rawseti(ls, -2, i + 1);
+    }
+    return 2;
+}
+
+static const struct luaL_reg snapshot_lib[] =
+{
+    { "feature", snapshot_feature },
+    { "cloud", snapshot_cloud },
+    { "is_safe_square", snapshot_is_safe_square },
+    { "flags", snapshot_flags },
+    { "monster_id", snapshot_monster_id },
+    { "monster", snapshot_monster },
+    { "changed", snapshot_changed },
+
+    { nullptr, nullptr }
+};
+/*** @section end
+ */
+
+/*** Take a snapshot of the squares in view.
+ * @treturn view.snapshot
+ * @function snapshot
+ */
+LUAFN(view_snapshot)
+{
+    view_snapshot_data **snap =
+        clua_new_userdata<view_snapshot_data *>(ls, VIEW_SNAPSHOT_METATABLE);
+    *snap = _take_snapshot();
+    return 1;
+}
+
 LUAFN(view_update_monsters)
 {
     ASSERT_DLUA;
@@ -214,6 +455,7 @@ static const struct luaL_reg view_lib[] =
     { "withheld", view_withheld },
     { "invisible_monster", view_invisible_monster },
     { "cell_see_cell", view_cell_see_cell },
+    { "snapshot", view_snapshot },
 
     { "update_monsters", view_update_monsters },
 
@@ -222,5 +464,7 @@ static const struct luaL_reg view_lib[] =
 
 void cluaopen_view(lua_State *ls)
 {
+    clua_register_metatable(ls, VIEW_SNAPSHOT_METATABLE, snapshot_lib,
+                            lua_object_gc<view_snapshot_data>);
     luaL_openlib(ls, "view", view_lib, 0);
 }
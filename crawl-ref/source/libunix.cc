@@ -73,6 +73,21 @@ static COLOURS BG_COL = BLACK;
 /** @brief The default background @em colour. */
 static COLOURS BG_COL_DEFAULT = BLACK;
 
+/**
+ * @brief The cells puttext() last sent to curses, and where they went.
+ *
+ * Cells that haven't changed since don't need to be sent again. Anything
+ * else that draws over that part of the screen empties this, since the
+ * screen no longer matches it.
+ */
+static vector<screen_cell_t> last_view;
+static coord_def last_view_pos;
+static coord_def last_view_size;
+
+/** @brief Running totals of cells puttext() was given and actually sent. */
+static unsigned long view_cells_drawn = 0;
+static unsigned long view_cells_sent = 0;
+
 struct curses_style
 {
     attr_t attr;
@@ -734,6 +749,7 @@ void console_startup()
     // Must call refresh() for ncurses to update COLS and LINES.
     refresh();
     crawl_view.init_geometry();
+    last_view.clear();
 
     set_mouse_enabled(false);
 
@@ -779,7 +795,22 @@ void cprintf(const char *format, ...)
     }
 }
 
-void putwch(char32_t chr)
+// Forget the last view if something other than puttext() is about to draw
+// over it at (x, y), or from there to the end of the line.
+static void _check_view_overwrite(int x, int y, bool to_eol = false)
+{
+    if (last_view.empty())
+        return;
+
+    if (y >= last_view_pos.y && y < last_view_pos.y + last_view_size.y
+        && (to_eol || x >= last_view_pos.x)
+        && x < last_view_pos.x + last_view_size.x)
+    {
+        last_view.clear();
+    }
+}
+
+static void _write_wch(char32_t chr)
 {
     wchar_t c = chr;
     if (!c)
@@ -795,22 +826,82 @@ void putwch(char32_t chr)
 #endif
 }
 
+void putwch(char32_t chr)
+{
+    _check_view_overwrite(wherex(), wherey());
+    _write_wch(chr);
+}
+
+/**
+ * Draw a view buffer at (x1, y1), sending curses only the runs of cells that
+ * differ from what we last drew there, and only changing colour when it
+ * actually changes. curses already avoids re-sending unchanged cells to the
+ * terminal, but it only finds out they were unchanged after we've paid for
+ * setting them up.
+ */
 void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
 {
     const screen_cell_t *cell = vbuf;
     const coord_def size = vbuf.size();
-    for (int y = 0; y < size.y; ++y)
+    const int ncells = size.x * size.y;
+    if (!ncells)
     {
-        cgotoxy(x1, y1 + y);
-        for (int x = 0; x < size.x; ++x)
+        update_screen();
+        return;
+    }
+
+    const bool incremental = !last_view.empty()
+                             && last_view_pos == coord_def(x1, y1)
+                             && last_view_size == size;
+    if (!incremental)
+    {
+        last_view.assign(cell, cell + ncells);
+        last_view_pos = coord_def(x1, y1);
+        last_view_size = size;
+    }
+
+    int colour = -1;
+    for (int y = 0, i = 0; y < size.y; ++y)
+    {
+        bool in_run = false;
+        for (int x = 0; x < size.x; ++x, ++i, ++cell)
         {
-            put_colour_ch(cell->colour, cell->glyph);
-            cell++;
+            screen_cell_t &last = last_view[i];
+            // Always send the last cell, so that the cursor ends up where
+            // it always has.
+            if (incremental && i != ncells - 1
+                && last.glyph == cell->glyph && last.colour == cell->colour)
+            {
+                in_run = false;
+                continue;
+            }
+
+            if (!in_run)
+            {
+                cgotoxy(x1 + x, y1 + y);
+                in_run = true;
+            }
+            if (cell->colour != colour)
+            {
+                colour = cell->colour;
+                textcolour(colour);
+            }
+            _write_wch(cell->glyph);
+            last = *cell;
+            ++view_cells_sent;
         }
     }
+    view_cells_drawn += ncells;
+
     update_screen();
 }
 
+void console_view_stats(unsigned long &drawn, unsigned long &sent)
+{
+    drawn = view_cells_drawn;
+    sent = view_cells_sent;
+}
+
 // These next four are front functions so that we can reduce
 // the amount of curses special code that occurs outside this
 // this file. This is good, since there are some issues with
@@ -833,6 +924,7 @@ void update_screen()
 
 void clear_to_end_of_line()
 {
+    _check_view_overwrite(wherex(), wherey(), true);
     textcolour(LIGHTGREY);
     textbackground(BLACK);
     clrtoeol();
@@ -859,6 +951,7 @@ int num_to_lines(int num)
 
 void clrscr()
 {
+    last_view.clear();
     textcolour(LIGHTGREY);
     textbackground(BLACK);
     clear();
@@ -1516,6 +1609,7 @@ void fakecursorxy(int x, int y)
 
     cchar_t c = character_at(y_curses, x_curses);
     flip_colour(c);
+    _check_view_overwrite(x, y);
     write_char_at(y_curses, x_curses, c);
 }
 
@@ -6,3 +6,7 @@
 
 void fakecursorxy(int x, int y);
 int unixcurses_get_vi_key(int keyin);
+
+// Running totals of the cells puttext() was asked to draw, and of those it
+// actually had to send to curses because they had changed.
+void console_view_stats(unsigned long &drawn, unsigned long &sent);
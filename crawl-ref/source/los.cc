@@ -48,6 +48,7 @@
 #include <cmath>
 
 #include "areas.h"
+#include "beam.h"
 #include "coord.h"
 #include "coordit.h"
 #include "env.h"
@@ -904,6 +905,7 @@ opacity_type mons_opacity(const monster* mon, los_type how)
 static void _handle_los_change()
 {
     invalidate_agrid();
+    invalidate_tracer_cache();
 }
 
 static bool _mons_block_sight(const monster* mons)
@@ -914,6 +916,9 @@ static bool _mons_block_sight(const monster* mons)
 
 void los_actor_moved(const actor* act, const coord_def& oldpos)
 {
+    // Whatever blocks sight, anything moving can change what a beam hits.
+    invalidate_tracer_cache();
+
     if (act->is_monster() && _mons_block_sight(act->as_monster()))
     {
         invalidate_los_around(oldpos);
@@ -924,6 +929,8 @@ void los_actor_moved(const actor* act, const coord_def& oldpos)
 
 void los_monster_died(const monster* mon)
 {
+    invalidate_tracer_cache();
+
     if (_mons_block_sight(mon))
     {
         invalidate_los_around(mon->pos());
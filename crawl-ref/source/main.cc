@@ -510,6 +510,21 @@ static void _show_commandline_options_help()
     puts("");
     puts("Arena options: (Stage a tournament between various monsters.)");
     puts("  -arena \"<monster list> v <monster list> arena:<arena map>\"");
+    puts("  -arena-batch <file>    fight each matchup in <file> without "
+         "display,");
+    puts("                         writing results to stdout as CSV");
+#ifdef WIZARD
+    puts("");
+    puts("Fight simulator options:");
+    puts("  -fsim-batch <file>     run the fight simulator on each "
+         "\"species | job |");
+    puts("                         skills | kit | monster\" line of <file>, "
+         "writing");
+    puts("                         results to stdout as TSV");
+    puts("  -fsim-jobs <num>       number of processes for -fsim-batch "
+         "(default: one");
+    puts("                         per core)");
+#endif
 #ifdef DEBUG_DIAGNOSTICS
     puts("");
     puts("Diagnostic options:");
@@ -2266,6 +2281,7 @@ void world_reacts()
         update_turn_count();
         msgwin_new_turn();
         crawl_state.lua_calls_no_turn = 0;
+        tracer_stats_new_turn();
         if (crawl_state.game_is_sprint()
             && !(you.num_turns % 256)
             && !you_are_delayed()
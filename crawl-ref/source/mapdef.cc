@@ -462,11 +462,13 @@ bool level_range::valid() const
 map_lines::map_lines()
     : markers(), lines(), overlay(),
       map_width(0), solid_north(false), solid_east(false),
-      solid_south(false), solid_west(false), solid_checked(false)
+      solid_south(false), solid_west(false), solid_checked(false),
+      caches_dirty(true), glyph_tables(), zones()
 {
 }
 
 map_lines::map_lines(const map_lines &map)
+    : caches_dirty(true)
 {
     init_from(map);
 }
@@ -506,6 +508,7 @@ char map_lines::operator () (const coord_def &c) const
 
 char& map_lines::operator () (const coord_def &c)
 {
+    invalidate_caches();
     return lines[c.y][c.x];
 }
 
@@ -516,6 +519,7 @@ char map_lines::operator () (int x, int y) const
 
 char& map_lines::operator () (int x, int y)
 {
+    invalidate_caches();
     return lines[y][x];
 }
 
@@ -546,6 +550,7 @@ void map_lines::init_from(const map_lines &map)
     // Markers have to be regenerated, they will not be copied.
     clear_markers();
     overlay.reset(nullptr);
+    invalidate_caches();
     lines            = map.lines;
     map_width        = map.map_width;
     solid_north      = map.solid_north;
@@ -705,11 +710,13 @@ const vector<string> &map_lines::get_lines() const
 
 vector<string> &map_lines::get_lines()
 {
+    invalidate_caches();
     return lines;
 }
 
 void map_lines::add_line(const string &s)
 {
+    invalidate_caches();
     lines.push_back(s);
     if (static_cast<int>(s.length()) > map_width)
         map_width = s.length();
@@ -1070,6 +1077,7 @@ void map_lines::extend(int min_width, int min_height, char fill)
     if (width() < min_width)
     {
         dirty = true;
+        invalidate_caches();
         lines[0] += string(min_width - width(), fill);
         map_width = max(map_width, min_width);
     }
@@ -1161,6 +1169,7 @@ bool map_lines::solid_borders(map_section_type border)
 void map_lines::clear()
 {
     clear_markers();
+    invalidate_caches();
     lines.clear();
     keyspecs.clear();
     overlay.reset(nullptr);
@@ -1181,6 +1190,7 @@ void map_lines::subst(string &s, subst_spec &spec)
 void map_lines::subst(subst_spec &spec)
 {
     ASSERT(!spec.key.empty());
+    invalidate_caches();
     for (string &line : lines)
         subst(line, spec);
 }
@@ -1489,6 +1499,7 @@ int map_lines::apply_nsubst(vector<coord_def> &pos, int start, int nsub,
         nsub = pos.size();
     const int end = min(start + nsub, (int) pos.size());
     int substituted = 0;
+    invalidate_caches();
     for (int i = start; i < end; ++i)
     {
         const int val = spec.value();
@@ -1532,6 +1543,7 @@ void map_lines::resolve_shuffle(const string &shufflage)
     if (toshuffle.empty() || shuffled.empty())
         return;
 
+    invalidate_caches();
     for (string &s : lines)
     {
         for (char &c : s)
@@ -1545,6 +1557,7 @@ void map_lines::resolve_shuffle(const string &shufflage)
 
 void map_lines::clear(const string &clearchars)
 {
+    invalidate_caches();
     for (string &s : lines)
     {
         for (char &c : s)
@@ -1558,6 +1571,7 @@ void map_lines::clear(const string &clearchars)
 
 void map_lines::normalise(char fillch)
 {
+    invalidate_caches();
     for (string &s : lines)
         if (static_cast<int>(s.length()) < map_width)
             s += string(map_width - s.length(), fillch);
@@ -1599,6 +1613,7 @@ void map_lines::rotate(bool clockwise)
         overlay = move(new_overlay);
     }
 
+    invalidate_caches();
     map_width = lines.size();
     lines     = newlines;
     rotate_markers(clockwise);
@@ -1652,6 +1667,7 @@ void map_lines::vmirror()
     const int vsize = lines.size();
     const int midpoint = vsize / 2;
 
+    invalidate_caches();
     for (int i = 0; i < midpoint; ++i)
     {
         string temp = lines[i];
@@ -1673,6 +1689,7 @@ void map_lines::vmirror()
 void map_lines::hmirror()
 {
     const int midpoint = map_width / 2;
+    invalidate_caches();
     for (string &s : lines)
         for (int j = 0; j < midpoint; ++j)
             swap(s[j], s[map_width - 1 - j]);
@@ -1896,55 +1913,165 @@ bool map_lines::find_bounds(const char *str, coord_def &tl, coord_def &br) const
     return br.x >= 0;
 }
 
-bool map_lines::fill_zone(travel_distance_grid_t &tpd, const coord_def &start,
-                          const coord_def &tl, const coord_def &br, int zone,
-                          const char *wanted, const char *passable) const
+// Called by anything that might write to lines. The layout builders poke
+// at cells through the non-const accessors all the time, so this has to be
+// cheap: the tables themselves are only dropped on the next lookup.
+void map_lines::invalidate_caches()
 {
-    // This is the map_lines equivalent of _dgn_fill_zone.
-    // It's unfortunately extremely similar, but not close enough to combine.
+    caches_dirty = true;
+}
 
-    bool ret = false;
-    list<coord_def> points[2];
-    int cur = 0;
+void map_lines::check_caches() const
+{
+    if (!caches_dirty)
+        return;
 
-    for (points[cur].push_back(start); !points[cur].empty();)
+    glyph_tables.clear();
+    zones.reset(nullptr);
+    caches_dirty = false;
+}
+
+static void _build_glyph_sums(vector<int> &sums, const vector<string> &lines,
+                              int width, char glyph)
+{
+    const int stride = width + 1;
+    sums.assign(stride * (lines.size() + 1), 0);
+    for (int y = 0, height = lines.size(); y < height; ++y)
     {
-        for (const auto &c : points[cur])
+        const string &line = lines[y];
+        int row = 0;
+        for (int x = 0; x < width; ++x)
         {
-            tpd[c.x][c.y] = zone;
+            if (x < (int) line.length() && line[x] == glyph)
+                ++row;
+            sums[(y + 1) * stride + x + 1] = sums[y * stride + x + 1] + row;
+        }
+    }
+}
+
+// Try to count the glyphs of feat in the box with summed-area tables.
+// Building a glyph's table costs as much as scanning the whole map, so we
+// only do it once brute-force counts of that glyph since the map last
+// changed have covered that many cells: a layout that alternates queries
+// with writes never pays more than twice what it did before, and one that
+// asks lots of questions of a finished map gets O(1) answers.
+bool map_lines::count_from_tables(const coord_def &tl, const coord_def &br,
+                                  const char *feat, int &count) const
+{
+    if (tl.x < 0 || tl.y < 0 || br.x < tl.x || br.y < tl.y
+        || br.x >= width() || br.y >= height())
+    {
+        return false;
+    }
 
-            ret |= (wanted && strchr(wanted, (*this)(c)) != nullptr);
+    check_caches();
 
-            for (int yi = -1; yi <= 1; ++yi)
-                for (int xi = -1; xi <= 1; ++xi)
-                {
-                    if (!xi && !yi)
-                        continue;
-
-                    const coord_def cp(c.x + xi, c.y + yi);
-                    if (cp.x < tl.x || cp.x > br.x
-                        || cp.y < tl.y || cp.y > br.y
-                        || !in_bounds(cp) || tpd[cp.x][cp.y]
-                        || passable && !strchr(passable, (*this)(cp)))
-                    {
-                        continue;
-                    }
-
-                    tpd[cp.x][cp.y] = zone;
-                    points[!cur].push_back(cp);
-                }
+    const int area = (br.x - tl.x + 1) * (br.y - tl.y + 1);
+    bool have_tables = true;
+    for (const char *f = feat; *f; ++f)
+    {
+        if (strchr(feat, *f) != f)
+            continue;
+
+        glyph_table &table = glyph_tables[*f];
+        if (table.sums.empty())
+        {
+            table.scanned += area;
+            if (table.scanned >= width() * height())
+                _build_glyph_sums(table.sums, lines, width(), *f);
+            else
+                have_tables = false;
         }
+    }
+
+    if (!have_tables)
+        return false;
 
-        points[cur].clear();
-        cur = !cur;
+    const int stride = width() + 1;
+    const int top = tl.y * stride, bottom = (br.y + 1) * stride;
+    count = 0;
+    for (const char *f = feat; *f; ++f)
+    {
+        if (strchr(feat, *f) != f)
+            continue;
+
+        const vector<int> &sums = glyph_tables[*f].sums;
+        count += sums[bottom + br.x + 1] - sums[bottom + tl.x]
+                 - sums[top + br.x + 1] + sums[top + tl.x];
     }
-    return ret;
+    return true;
+}
+
+// Split the passable cells of the box into 8-connected zones. The labels
+// stay valid until the map changes, so repeated fills of the same area
+// don't redo the labelling.
+void map_lines::label_zones(const coord_def &tl, const coord_def &br,
+                            const char *wanted, const char *passable) const
+{
+    check_caches();
+
+    if (zones && zones->labels.tl == tl && zones->labels.br == br
+        && zones->wanted == (wanted ? wanted : "")
+        && zones->any_passable == !passable
+        && zones->passable == (passable ? passable : ""))
+    {
+        return;
+    }
+
+    zones.reset(new zone_labels);
+    zones->wanted = wanted ? wanted : "";
+    zones->passable = passable ? passable : "";
+    zones->any_passable = !passable;
+
+    ::label_zones(zones->labels, tl, br,
+                  [&](const coord_def &c)
+                  {
+                      return in_bounds(c)
+                             && (!passable
+                                 || strchr(passable, lines[c.y][c.x]));
+                  },
+                  [&](const coord_def &c) -> unsigned
+                  {
+                      return wanted && strchr(wanted, lines[c.y][c.x]);
+                  });
+}
+
+void map_lines::fill_disconnected(const coord_def &tl, const coord_def &br,
+                                  char fill, const char *wanted,
+                                  const char *passable)
+{
+    label_zones(tl, br, wanted, passable);
+
+    zone_map &labels = zones->labels;
+    bool filled = false;
+    for (rectangle_iterator ri(tl, br); ri; ++ri)
+    {
+        int &zone = labels(*ri);
+        if (!zone || labels.flags[zone])
+            continue;
+
+        lines[ri->y][ri->x] = fill;
+        zone = 0;
+        filled = true;
+    }
+
+    if (!filled)
+        return;
+
+    // The glyph counts are stale now, but as long as the fill glyph is
+    // impassable the zones that are left are just as they were.
+    glyph_tables.clear();
+    if (!passable || strchr(passable, fill))
+        zones.reset(nullptr);
 }
 
 int map_lines::count_feature_in_box(const coord_def &tl, const coord_def &br,
                                     const char *feat) const
 {
     int result = 0;
+    if (count_from_tables(tl, br, feat, result))
+        return result;
+
     for (rectangle_iterator ri(tl, br); ri; ++ri)
     {
         if (strchr(feat, (*this)(*ri)))
@@ -19,6 +19,7 @@
 #include <vector>
 #include <unordered_set>
 
+#include "dgn-zones.h"
 #include "dlua.h"
 #include "enum.h"
 #include "fprop.h"
@@ -433,9 +434,11 @@ public:
     // Extend map dimensions with glyph 'fill' to minimum width and height.
     void extend(int min_width, int min_height, char fill);
 
-    bool fill_zone(travel_distance_grid_t &tpd, const coord_def &start,
-                   const coord_def &tl, const coord_def &br, int zone,
-                   const char *wanted, const char *passable) const;
+    // Fill every zone of passable glyphs within the box that doesn't
+    // contain a wanted glyph with 'fill'.
+    void fill_disconnected(const coord_def &tl, const coord_def &br,
+                           char fill, const char *wanted,
+                           const char *passable);
 
     int count_feature_in_box(const coord_def &tl, const coord_def &br,
                              const char *feat) const;
@@ -487,6 +490,13 @@ private:
 
     string add_tile(const string &sub, bool is_floor, bool is_feat);
 
+    void invalidate_caches();
+    void check_caches() const;
+    bool count_from_tables(const coord_def &tl, const coord_def &br,
+                           const char *feat, int &count) const;
+    void label_zones(const coord_def &tl, const coord_def &br,
+                     const char *wanted, const char *passable) const;
+
     string add_key_field(
         const string &s,
         string (keyed_mapspec::*set_field)(const string &s, bool fixed),
@@ -538,6 +548,31 @@ private:
     int map_width;
     bool solid_north, solid_east, solid_south, solid_west;
     bool solid_checked;
+
+    // Lookup tables for the layout builder's queries, built lazily and
+    // thrown away as soon as anything might have written to the map.
+    struct glyph_table
+    {
+        glyph_table() : scanned(0) { }
+
+        // Summed-area table: sums[y * (width + 1) + x] is the number of
+        // cells with this glyph in the rectangle [0, x) x [0, y).
+        vector<int> sums;
+        // Cells counted by brute force since the map last changed.
+        int scanned;
+    };
+
+    struct zone_labels
+    {
+        string wanted, passable;
+        bool any_passable;
+        // A zone's flags are set if it contains a wanted glyph.
+        zone_map labels;
+    };
+
+    mutable bool caches_dirty;
+    mutable map<char, glyph_table> glyph_tables;
+    mutable unique_ptr<zone_labels> zones;
 };
 
 enum item_spec_type
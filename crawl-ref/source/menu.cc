@@ -468,7 +468,7 @@ public:
         m_text.clear();
         m_text += fs;
         _expose();
-        m_wrapped_size = Size(-1);
+        _invalidate_wrap();
         wrap_text_to_size(m_region.width, m_region.height);
     };
 };
@@ -2035,11 +2035,20 @@ bool Menu::line_up()
 }
 
 #ifdef USE_TILE_WEB
+// How many items a menu sends when it opens, and how many of those come
+// before the first visible one.
+static const int WEBTILES_MENU_CHUNK = 100;
+static const int WEBTILES_MENU_MARGIN = 20;
+
 void Menu::webtiles_write_menu(bool replace) const
 {
     if (crawl_state.doing_prev_cmd_again)
         return;
 
+#ifdef DEBUG_WEBSOCKETS
+    const size_t initial_size = tiles.json_size();
+#endif
+
     tiles.json_open_object();
     tiles.json_write_string("msg", "menu");
     tiles.json_write_bool("ui-centred", !crawl_state.need_save);
@@ -2053,14 +2062,18 @@ void Menu::webtiles_write_menu(bool replace) const
     tiles.json_write_string("more",
             m_keyhelp_more ? "" : more.to_colour_string());
 
+    // Only send the items around where the menu opens; the client asks for
+    // the rest (with *request_menu_range) as they scroll into view.
     int count = items.size();
-    int start = 0;
-    int end = start + count;
+    int first_entry = get_first_visible();
+    int start = is_set(MF_START_AT_END) ? count - WEBTILES_MENU_CHUNK
+                                        : first_entry - WEBTILES_MENU_MARGIN;
+    start = max(0, min(start, count - WEBTILES_MENU_CHUNK));
+    int end = min(start + WEBTILES_MENU_CHUNK, count);
 
     tiles.json_write_int("total_items", count);
     tiles.json_write_int("chunk_start", start);
 
-    int first_entry = get_first_visible();
     if (first_entry != 0 && !is_set(MF_START_AT_END))
         tiles.json_write_int("jump_to", first_entry);
 
@@ -2072,6 +2085,12 @@ void Menu::webtiles_write_menu(bool replace) const
     tiles.json_close_array();
 
     tiles.json_close_object();
+
+#ifdef DEBUG_WEBSOCKETS
+    fprintf(stderr, "websocket: menu '%s' sent items %d-%d of %d, %d bytes.\n",
+            tag.c_str(), start, end - 1, count,
+            (int) (tiles.json_size() - initial_size));
+#endif
 }
 
 void Menu::webtiles_scroll(int first)
@@ -2101,6 +2120,8 @@ void Menu::webtiles_handle_item_request(int start, int end)
     tiles.json_write_string("msg", "update_menu_items");
 
     tiles.json_write_int("chunk_start", start);
+    // These are whole items, not just the changes to them.
+    tiles.json_write_bool("complete", true);
 
     tiles.json_open_array("items");
 
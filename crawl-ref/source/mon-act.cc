@@ -13,6 +13,7 @@
 #include "arena.h"
 #include "artefact.h"
 #include "attitude-change.h"
+#include "beam.h"
 #include "bloodspatter.h"
 #include "cloud.h"
 #include "colour.h"
@@ -76,10 +77,14 @@
 #include "view.h"
 
 typedef FixedArray< bool, 3, 3 > move_array;
+struct move_context;
 
 static bool _handle_pickup(monster* mons);
 static bool _monster_move(monster* mons);
-static bool _can_move(monster* mons, move_array * moves, bool * preferred_available);
+static bool _can_move(monster* mons, move_context &ctx, move_array * moves,
+                      bool * preferred_available);
+static bool _mon_can_move_to_pos(const monster* mons, const coord_def& delta,
+                                 bool just_check, move_context &ctx);
 
 // [dshaligram] Doesn't need to be extern.
 static coord_def mmov;
@@ -458,6 +463,52 @@ static bool _mons_can_cast_dig(const monster* mons, bool random)
             && !(mons->is_silenced() && flags & MON_SPELL_SILENCE_MASK);
 }
 
+// What a monster needs to know about its own square to judge its possible
+// moves. None of it depends on which neighbour is being looked at, so it is
+// worked out once per move instead of once per neighbour; the cloud verdicts
+// are kept too, since the move code asks about the same squares repeatedly.
+struct move_context
+{
+    explicit move_context(const monster* _mons)
+        : mons(_mons), pos(_mons->pos()),
+          habitat(mons_primary_habitat(*_mons)),
+          in_sanctuary(is_sanctuary(pos)),
+          silenced_here(silenced(pos)),
+          digs(_mons_can_cast_dig(_mons, false)),
+          slime_walls(-1)
+    {
+        clouds.init(UNKNOWN);
+    }
+
+    // Does the monster avoid the cloud, if any, at pos + delta?
+    bool avoids_cloud(const coord_def &delta)
+    {
+        int8_t &avoids = clouds[delta.x + 1][delta.y + 1];
+        if (avoids == UNKNOWN)
+            avoids = mons_avoids_cloud(mons, pos + delta);
+        return avoids;
+    }
+
+    int slime_walls_here()
+    {
+        if (slime_walls < 0)
+            slime_walls = count_adjacent_slime_walls(pos);
+        return slime_walls;
+    }
+
+    const monster* const mons;
+    const coord_def pos;
+    const habitat_type habitat;
+    const bool in_sanctuary;
+    const bool silenced_here;
+    const bool digs;
+
+private:
+    enum { UNKNOWN = -1 };
+    FixedArray<int8_t, 3, 3> clouds;
+    int slime_walls;
+};
+
 static void _set_mons_move_dir(const monster* mons,
                                coord_def* dir, coord_def* delta)
 {
@@ -490,6 +541,7 @@ static void _set_mons_move_dir(const monster* mons,
 
 static void _fill_good_move(const monster* mons, move_array* good_move)
 {
+    move_context ctx(mons);
     for (int count_x = 0; count_x < 3; count_x++)
         for (int count_y = 0; count_y < 3; count_y++)
         {
@@ -504,7 +556,8 @@ static void _fill_good_move(const monster* mons, move_array* good_move)
             }
 
             (*good_move)[count_x][count_y] =
-                mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1));
+                _mon_can_move_to_pos(mons, coord_def(count_x-1, count_y-1),
+                                     false, ctx);
         }
 }
 
@@ -1865,6 +1918,10 @@ void handle_monster_move(monster* mons, int tries)
     if (!entry)
         return;
 
+    // Tracers are only shared within a single monster's move; anything
+    // that happened since the last one may have changed their outcome.
+    invalidate_tracer_cache();
+
     const bool disabled = crawl_state.disables[DIS_MON_ACT]
                           && _unfriendly_or_impaired(*mons);
 
@@ -2206,16 +2263,18 @@ void handle_monster_move(monster* mons, int tries)
         bool preferred_available = false;
         bool want_move = false;
         move_array unused;
+        move_context ctx(mons);
 
-        if (!mons->is_stationary() && _can_move(mons, &unused, &preferred_available))
+        if (!mons->is_stationary()
+            && _can_move(mons, ctx, &unused, &preferred_available))
         {
             // If a monster can move and the move would pull it out of danger it prefers this to attacking.
             // Wants to stop drowning.
             want_move = (mons->submerged() && !mons->swimming());
             // Wants to get into a wall.
-            want_move |= ((mons_primary_habitat(*mons) == HT_ROCK || mons_primary_habitat(*mons) == HT_STEEL) && !feat_is_solid(grd(mons->pos())) && preferred_available);
+            want_move |= ((ctx.habitat == HT_ROCK || ctx.habitat == HT_STEEL) && !feat_is_solid(grd(mons->pos())) && preferred_available);
             // Wants to get out of the cloud.
-            want_move |= (mons_avoids_cloud(mons, mons->pos()) && preferred_available);
+            want_move |= (ctx.avoids_cloud(coord_def(0, 0)) && preferred_available);
         }
 
         if (mons->pos() + mmov == you.pos() && !want_move)
@@ -3121,7 +3180,7 @@ static bool _mons_can_displace(const monster* mpusher,
 // Returns true if the monster should try to avoid that position
 // because of taking damage from slime walls.
 static bool _check_slime_walls(const monster *mon,
-                               const coord_def &targ)
+                               const coord_def &targ, move_context &ctx)
 {
     if (actor_slime_wall_immune(mon) || mons_intel(*mon) <= I_BRAINLESS)
         return false;
@@ -3130,8 +3189,7 @@ static bool _check_slime_walls(const monster *mon,
     if (!target_count)
         return false;
 
-    const int current_count = count_adjacent_slime_walls(mon->pos());
-    if (target_count <= current_count)
+    if (target_count <= ctx.slime_walls_here())
         return false;
 
     // The monster needs to have a purpose to risk taking damage.
@@ -3218,6 +3276,13 @@ bool mon_avoids_terrain(const monster* mons, dungeon_feature_type terrain)
 // calls from is_trap_safe when checking the surrounding squares of a trap.
 bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
                          bool just_check)
+{
+    move_context ctx(mons);
+    return _mon_can_move_to_pos(mons, delta, just_check, ctx);
+}
+
+static bool _mon_can_move_to_pos(const monster* mons, const coord_def& delta,
+                                 bool just_check, move_context &ctx)
 {
     const coord_def targ = mons->pos() + delta;
 
@@ -3228,18 +3293,18 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
     // Non-friendly and non-good neutral monsters won't enter
     // sanctuaries.
     if (is_sanctuary(targ)
-        && !is_sanctuary(mons->pos())
+        && !ctx.in_sanctuary
         && !mons->wont_attack())
     {
         return false;
     }
 
     // Inside a sanctuary don't attack anything!
-    if (is_sanctuary(mons->pos()) && actor_at(targ))
+    if (ctx.in_sanctuary && actor_at(targ))
         return false;
 
     const dungeon_feature_type target_grid = grd(targ);
-    const habitat_type habitat = mons_primary_habitat(*mons);
+    const habitat_type habitat = ctx.habitat;
 
     // No monster may enter the open sea.
     if (feat_is_endless(target_grid))
@@ -3262,17 +3327,17 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
     if (mons->confused() && mons->can_pass_through(targ))
         return true;
 
-    if (mons_avoids_cloud(mons, targ))
+    if (ctx.avoids_cloud(delta))
         return false;
 
     // Creatures that primarily kill will silenceable spells won't willingly enter silence.
-    if (silenced(targ) && !silenced(mons->pos()) && ((mons->is_actual_spellcaster() || mons->is_priest()) && !mons->is_fighter()))
+    if (silenced(targ) && !ctx.silenced_here && ((mons->is_actual_spellcaster() || mons->is_priest()) && !mons->is_fighter()))
         return false;
 
-    if (env.level_state & LSTATE_SLIMY_WALL && _check_slime_walls(mons, targ))
+    if (env.level_state & LSTATE_SLIMY_WALL && _check_slime_walls(mons, targ, ctx))
         return false;
 
-    const bool digs = _mons_can_cast_dig(mons, false);
+    const bool digs = ctx.digs;
     if ((target_grid == DNGN_ROCK_WALL || target_grid == DNGN_CLEAR_ROCK_WALL
         || target_grid == DNGN_SLIMY_WALL)
            && (mons_class_flag(mons->type, M_BURROWS) || digs 
@@ -3310,7 +3375,7 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
         || (mons->type == MONS_LURKING_HORROR
             && mons->foe_distance() > random2(LOS_DEFAULT_RANGE + 1)))
     {
-        if (!mons->wont_attack() && is_sanctuary(mons->pos()))
+        if (!mons->wont_attack() && ctx.in_sanctuary)
             return true;
 
         if (!mons->friendly() && you.see_cell(targ)
@@ -3836,7 +3901,8 @@ static void _preferential_move(move_array good_move, monster* mons, function<boo
         }
 }
 
-static bool _can_move(monster* mons, move_array * moves, bool * preferred_available)
+static bool _can_move(monster* mons, move_context &ctx, move_array * moves,
+                      bool * preferred_available)
 {
     *preferred_available = false;
     bool retval = false;
@@ -3854,10 +3920,11 @@ static bool _can_move(monster* mons, move_array * moves, bool * preferred_availa
                 continue;
             }
 
-            if (mon_can_move_to_pos(mons, coord_def(count_x - 1, count_y - 1)))
+            const coord_def delta(count_x - 1, count_y - 1);
+            if (_mon_can_move_to_pos(mons, delta, false, ctx))
             {
                 const dungeon_feature_type target_grid = grd[targ_x][targ_y];
-                const habitat_type habitat = mons_primary_habitat(*mons);
+                const habitat_type habitat = ctx.habitat;
 
                 retval = true;
                 (*moves)[count_x][count_y] = true;
@@ -3877,7 +3944,7 @@ static bool _can_move(monster* mons, move_array * moves, bool * preferred_availa
                         *preferred_available = true;
                 }
 
-                if (mons_avoids_cloud(mons, mons->pos()) && !mons_avoids_cloud(mons, coord_def(targ_x, targ_y)))
+                if (ctx.avoids_cloud(coord_def(0, 0)) && !ctx.avoids_cloud(delta))
                     *preferred_available = true;
             }
             else
@@ -3968,7 +4035,8 @@ static bool _monster_move(monster* mons)
     if (mmov.origin())
         return false;
 
-    if (!_can_move(mons, &good_move, &preferred_available))
+    move_context ctx(mons);
+    if (!_can_move(mons, ctx, &good_move, &preferred_available))
         return false;
 
     // Now we know where we _can_ move.
@@ -4013,11 +4081,11 @@ static bool _monster_move(monster* mons)
     }
 
     // Monsters in damaging clouds prefer to leave the cloud
-    else if (mons_avoids_cloud(mons, mons->pos()) && mons_avoids_cloud(mons, newpos) && preferred_available)
+    else if (ctx.avoids_cloud(coord_def(0, 0)) && ctx.avoids_cloud(mmov) && preferred_available)
     {
         _preferential_move(good_move, mons,
-            [](monster * m, coord_def c)
-        { return !mons_avoids_cloud(m, coord_def(m->pos().x + c.x - 1, m->pos().y + c.y - 1))
+            [&ctx](monster * m, coord_def c)
+        { return !ctx.avoids_cloud(c - coord_def(1, 1))
             && (grid_distance(m->target, coord_def(m->pos().x + c.x - 1, m->pos().y + c.y - 1)) <=
                 grid_distance(m->target, m->pos())); });
     }
@@ -4050,7 +4118,7 @@ static bool _monster_move(monster* mons)
 
     const bool burrows = mons_class_flag(mons->type, M_BURROWS);
     const bool flattens_trees = mons_flattens_trees(*mons);
-    const bool digs = _mons_can_cast_dig(mons, false);
+    const bool digs = ctx.digs;
     // Take care of Dissolution burrowing, lerny, etc
     if (burrows || flattens_trees || digs)
     {
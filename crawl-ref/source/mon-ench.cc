@@ -115,6 +115,9 @@ mon_enchant monster::get_ench(enchant_type ench1,
 
     for (int e = ench1; e <= ench2; ++e)
     {
+        if (!ench_cache[e])
+            continue;
+
         auto i = enchantments.find(static_cast<enchant_type>(e));
 
         if (i != enchantments.end())
@@ -126,7 +129,7 @@ mon_enchant monster::get_ench(enchant_type ench1,
 
 void monster::update_ench(const mon_enchant &ench)
 {
-    if (ench.ench != ENCH_NONE)
+    if (ench.ench != ENCH_NONE && ench_cache[ench.ench])
     {
         if (mon_enchant *curr_ench = map_find(enchantments, ench.ench))
             *curr_ench = ench;
@@ -337,6 +340,9 @@ void monster::add_enchantment_effect(const mon_enchant &ench, bool quiet)
 
 bool monster::del_ench(enchant_type ench, bool quiet, bool effect)
 {
+    if (!ench_cache[ench])
+        return false;
+
     auto i = enchantments.find(ench);
     if (i == enchantments.end())
         return false;
@@ -344,7 +350,7 @@ bool monster::del_ench(enchant_type ench, bool quiet, bool effect)
     const mon_enchant me = i->second;
     const enchant_type et = i->first;
 
-    enchantments.erase(et);
+    enchantments.erase(i);
     ench_cache.set(et, false);
     if (effect)
         remove_enchantment_effect(me, quiet);
@@ -1915,7 +1921,7 @@ void monster::apply_enchantment(const mon_enchant &me)
             if (res_water_drowning() <= 0)
             {
                 lose_ench_duration(me, -dur);
-                int dam = div_rand_round((50 + stepdown((float)me.duration, 30.0))
+                int dam = div_rand_round((50 + stepdown((float)get_ench(en).duration, 30.0))
                                           * dur,
                             BASELINE_DELAY * 10);
                 if (res_water_drowning() < 0)
@@ -1934,7 +1940,7 @@ void monster::apply_enchantment(const mon_enchant &me)
             {
                 lose_ench_duration(me, -speed_to_duration(speed));
                 int dur = speed_to_duration(speed); // sequence point for randomness
-                int dam = div_rand_round((50 + stepdown((float)me.duration, 30.0))
+                int dam = div_rand_round((50 + stepdown((float)get_ench(en).duration, 30.0))
                     * dur,
                     BASELINE_DELAY * 10);
                 hurt(me.agent(), dam);
@@ -2123,10 +2129,12 @@ void monster::apply_enchantments()
     FixedBitVector<NUM_ENCHANTMENTS> ec = ench_cache;
 
     // The ordering in enchant_type makes sure that "super-enchantments"
-    // like berserk time out before their parts.
+    // like berserk time out before their parts. Each enchantment is handed
+    // over as a copy, since applying it may add or remove others and so
+    // shuffle the entries of the list around.
     for (int i = 0; i < NUM_ENCHANTMENTS; ++i)
         if (ec[i] && has_ench(static_cast<enchant_type>(i)))
-            apply_enchantment(enchantments.find(static_cast<enchant_type>(i))->second);
+            apply_enchantment(get_ench(static_cast<enchant_type>(i)));
 }
 
 // Used to adjust time durations in calc_duration() for monster speed.
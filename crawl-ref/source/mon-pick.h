@@ -43,6 +43,7 @@ public:
                                 mon_pick_vetoer vetoer = nullptr);
 
     virtual bool veto(monster_type mon) override;
+    virtual bool may_veto() override { return _veto != nullptr; }
 
 private:
     mon_pick_vetoer _veto;
@@ -56,6 +57,7 @@ public:
         : monster_picker(), pos(_pos), posveto(_posveto) { };
 
     virtual bool veto(monster_type mon) override;
+    virtual bool may_veto() override { return true; }
 
 protected:
     const coord_def &pos;
@@ -24,6 +24,7 @@
 #include "env.h"
 #include "errors.h"
 #include "fprop.h"
+#include "free-slots.h"
 #include "gender-type.h"
 #include "ghost.h"
 #include "god-abil.h"
@@ -873,16 +874,34 @@ monster* place_monster(mgen_data mg, bool force_pos, bool dont_place)
     return mon;
 }
 
+// The menv slots known to be free; see free-slots.h.
+static free_slot_list<MAX_MONSTERS> _free_monsters;
+
+static bool _monster_slot_free(int mindex)
+{
+    return menv[mindex].type == MONS_NO_MONSTER;
+}
+
+// Called whenever menv has been replaced wholesale (a new or newly loaded
+// level).
+void rebuild_monster_free_list()
+{
+    _free_monsters.rebuild(_monster_slot_free);
+}
+
+void monster_slot_freed(int mindex)
+{
+    _free_monsters.release(mindex);
+}
+
 monster* get_free_monster()
 {
-    for (auto &mons : menv_real)
-        if (mons.type == MONS_NO_MONSTER)
-        {
-            mons.reset();
-            return &mons;
-        }
+    const int mindex = _free_monsters.take(MAX_MONSTERS, _monster_slot_free);
+    if (mindex == -1)
+        return nullptr;
 
-    return nullptr;
+    menv[mindex].reset();
+    return &menv[mindex];
 }
 
 void mons_add_blame(monster* mon, const string &blame_string)
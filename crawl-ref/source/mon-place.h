@@ -116,6 +116,8 @@ void set_vault_mon_list(const vector<mons_spec> &list);
 void setup_vault_mon_list();
 
 monster* get_free_monster();
+void rebuild_monster_free_list();
+void monster_slot_freed(int mindex);
 
 bool can_place_on_trap(monster_type mon_type, trap_type trap);
 void mons_add_blame(monster* mon, const string &blame_string);
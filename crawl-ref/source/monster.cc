@@ -164,6 +164,10 @@ void monster::reset()
     // Just for completeness.
     speed           = 0;
     colour         = COLOUR_INHERIT;
+
+    // A monster in menv that has been reset leaves its slot free. If the
+    // slot is refilled straight away, take() will skip it.
+    monster_slot_freed(mindex());
 }
 
 void monster::init_with(const monster& mon)
@@ -5,6 +5,7 @@
 #include "actor.h"
 #include "beh-type.h"
 #include "enchant-type.h"
+#include "flatmap.h"
 #include "mon-ench.h"
 #include "mon-poly.h"
 #include "montravel-target-type.h"
@@ -36,7 +37,9 @@ const int KRAKEN_TENTACLE_RANGE = 3;
 
 #define MAP_KEY "map"
 
-typedef map<enchant_type, mon_enchant> mon_enchant_list;
+// Most monsters carry no more than a few enchantments at a time; keep them
+// inline and sorted rather than paying for a tree node apiece.
+typedef SmallFlatMap<enchant_type, mon_enchant, 6> mon_enchant_list;
 
 struct monsterentry;
 
@@ -596,6 +596,7 @@ public:
     bool        tile_level_map_hide_messages;
     bool        tile_level_map_hide_sidebar;
     bool        tile_web_mouse_control;
+    bool        tile_web_send_stats;
 #endif
 #endif // USE_TILE
 
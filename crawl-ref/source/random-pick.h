@@ -5,6 +5,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "random.h"
 
 enum distrib_type
@@ -37,17 +42,85 @@ public:
     int rarity_at(const random_pick_entry<T> *pop,
                   int depth);
     virtual bool veto(T) { return false; }
+
+    // Whether veto() might turn anything down in the coming pick(). Pickers
+    // that know it won't can say so, and pick() will use a cached table of
+    // rarities for the weights and level instead of working them out
+    // afresh; the table is keyed on the address of the weights, so they
+    // have to be static.
+    virtual bool may_veto() { return true; }
+
+    // Whether pick() may use cached tables at all; turned off to check
+    // they give the same picks as the slow way.
+    static bool use_tables;
+
+private:
+    // The candidates for one (weights, level) pair, with the running total
+    // of their rarities.
+    struct pick_table
+    {
+        vector<pair<int, T>> cumulative;
+        int total = 0;
+        bool built = false;
+    };
+
+    const pick_table &table_for(const random_pick_entry<T> *weights,
+                                int level);
 };
 
+template <typename T, int max>
+bool random_picker<T, max>::use_tables = true;
+
 template <typename T, int max>
 random_picker<T, max>::~random_picker()
 {
 }
 
+template <typename T, int max>
+const typename random_picker<T, max>::pick_table &
+random_picker<T, max>::table_for(const random_pick_entry<T> *weights,
+                                 int level)
+{
+    static map<pair<const random_pick_entry<T> *, int>, pick_table> tables;
+
+    pick_table &table = tables[make_pair(weights, level)];
+    if (table.built)
+        return table;
+
+    table.built = true;
+    for (const random_pick_entry<T> *pop = weights; pop->rarity; pop++)
+    {
+        if (level < pop->minr || level > pop->maxr)
+            continue;
+
+        int rar = rarity_at(pop, level);
+        ASSERTM(rar > 0, "Rarity %d: %d at level %d", rar, pop->value, level);
+
+        table.total += rar;
+        table.cumulative.emplace_back(table.total, pop->value);
+    }
+    return table;
+}
+
 template <typename T, int max>
 T random_picker<T, max>::pick(const random_pick_entry<T> *weights, int level,
                               T none)
 {
+    if (use_tables && !may_veto())
+    {
+        const pick_table &table = table_for(weights, level);
+        if (table.cumulative.empty())
+            return none;
+
+        // The same roll as below: the first entry whose running total
+        // exceeds it.
+        const int roll = random2(table.total);
+        return upper_bound(table.cumulative.begin(), table.cumulative.end(),
+                           roll,
+                           [](int r, const pair<int, T> &entry)
+                           { return r < entry.first; })->second;
+    }
+
     struct { T value; int rarity; } valid[max];
     int nvalid = 0;
     int totalrar = 0;
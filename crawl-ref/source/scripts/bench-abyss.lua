@@ -0,0 +1,32 @@
+-- Measures abyss area shifts per second, both when every shift moves on to
+-- fresh abyss and when the player keeps stepping back and forth between the
+-- same two stretches of it.
+--
+-- Usage: crawl -script bench-abyss [<shifts>]
+
+local args = script.simple_args()
+local shifts = tonumber(args[1]) or 200
+
+debug.goto_place("Abyss")
+test.regenerate_level()
+
+local gxm, gym = dgn.max_bounds()
+local east, west = gxm - 12, 11
+
+-- Teleporting this close to the edge of the map triggers a shift, which
+-- recentres the level on the player.
+local function time_shifts(back_and_forth)
+  local start = crawl.millis()
+  for i = 1, shifts do
+    local x = (back_and_forth and i % 2 == 0) and west or east
+    you.teleport_to(x, math.floor(gym / 2))
+  end
+  return crawl.millis() - start
+end
+
+for _, run in ipairs({ { "onwards", false }, { "back and forth", true } }) do
+  local elapsed = time_shifts(run[2])
+  crawl.stderr(string.format("%s: %d shifts in %d ms (%.1f shifts/s)",
+                             run[1], shifts, elapsed,
+                             shifts * 1000 / math.max(1, elapsed)))
+end
@@ -0,0 +1,45 @@
+-- Times the catch-up done on returning to a level (update_level()) against
+-- the time spent away.
+--
+-- Usage: crawl -script bench-catchup [<place> ...]
+
+local places = script.simple_args()
+if #places == 0 then
+  places = { "Lair:1", "Orc:1", "Vaults:1", "Elf:1" }
+end
+
+local absences = { 100, 1000, 10000, 100000, 1000000 }
+local repeats = 20
+
+-- Time update_level(aut) on freshly generated copies of place. When wounded
+-- is set, every monster is first hurt a little, so that none of them can
+-- skip the per-monster work.
+local function time_catchup(place, aut, wounded)
+  local total = 0
+  for i = 1, repeats do
+    debug.reset_rng(i)
+    debug.goto_place(place)
+    test.regenerate_level()
+    if wounded then
+      for mons in test.level_monster_iterator() do
+        if mons.hp > 1 then
+          mons.set_hp(mons.hp - 1)
+        end
+      end
+    end
+
+    local start = crawl.millis()
+    debug.update_level(aut)
+    total = total + crawl.millis() - start
+  end
+  return total / repeats
+end
+
+crawl.stderr("place\taway (aut)\tidle (ms)\twounded (ms)")
+for _, place in ipairs(places) do
+  for _, aut in ipairs(absences) do
+    crawl.stderr(string.format("%s\t%d\t%.2f\t%.2f", place, aut,
+                               time_catchup(place, aut, false),
+                               time_catchup(place, aut, true)))
+  end
+end
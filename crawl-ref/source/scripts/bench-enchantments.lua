@@ -0,0 +1,41 @@
+-- Times monster::apply_enchantments() over a level full of buffed allies.
+--
+-- Usage: crawl -script bench-enchantments [<rounds>]
+
+local args = script.simple_args()
+local rounds = tonumber(args[1]) or 1000
+local ally = "orc warrior att:friendly"
+local buffs = { "haste", "might", "swift", "regen", "magic_res",
+                "resistant", "agile" }
+
+debug.goto_place("D:1")
+test.regenerate_level()
+dgn.dismiss_monsters()
+
+local gxm, gym = dgn.max_bounds()
+local placed = 0
+for y = 1, gym - 2 do
+  for x = 1, gxm - 2 do
+    if placed < dgn.max_monsters() - 1
+       and dgn.grid(x, y) == dgn.find_feature_number("floor")
+       and not dgn.mons_at(x, y) then
+      local mons = dgn.create_monster(x, y, ally)
+      if mons then
+        -- Infinite durations, so that nothing wears off mid-run.
+        for _, buff in ipairs(buffs) do
+          mons.add_ench(buff, 1, 30000)
+        end
+        placed = placed + 1
+      end
+    end
+  end
+end
+
+local start = crawl.millis()
+debug.apply_enchantments(rounds)
+local elapsed = crawl.millis() - start
+
+crawl.stderr(string.format("%d monsters x %d buffs, %d rounds: %d ms "
+                           .. "(%.3f us/monster)",
+                           placed, #buffs, rounds, elapsed,
+                           elapsed * 1000 / math.max(1, placed * rounds)))
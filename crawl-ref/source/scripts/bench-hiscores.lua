@@ -0,0 +1,21 @@
+-- Times adding games to the score table. Point it at a scratch score file,
+-- and run several at once to see how games ending together get on:
+--
+--   for i in 1 2 3 4; do
+--     crawl -scorefile /tmp/bench-scores -script bench-hiscores 500 &
+--   done; wait
+--
+-- Usage: crawl -scorefile <file> -script bench-hiscores [<entries>]
+
+local args = script.simple_args()
+local entries = tonumber(args[1]) or 500
+
+local start = crawl.millis()
+for i = 1, entries do
+  debug.new_score_entry()
+end
+local elapsed = crawl.millis() - start
+
+crawl.stderr(string.format("%d scores in %d ms (%.1f scores/s)",
+                           entries, elapsed,
+                           entries * 1000 / math.max(1, elapsed)))
@@ -0,0 +1,130 @@
+-- Times the level builder on a fixed set of places and seeds, broken down
+-- by phase, and counts the vetoes along the way. The seeds are fixed, so
+-- two runs of the same build generate the same levels and any difference
+-- in time is down to the code.
+--
+-- Save a baseline, change something, then compare against it:
+--
+--   crawl -script bench-levelgen -save=levelgen.tsv
+--   crawl -script bench-levelgen -compare=levelgen.tsv
+--
+-- Comparing fails if any place got more than 20% slower, or if the number
+-- of vetoes changed (which means the levels themselves did).
+--
+-- Usage: crawl -script bench-levelgen [-save=<file>] [-compare=<file>]
+--                                     [-seeds=<n>] [<place> ...]
+
+local places = script.simple_args()
+if #places == 0 then
+  places = { "D:1", "D:10", "Lair:3", "Orc:2", "Elf:2", "Vaults:3",
+             "Depths:2", "Zot:4" }
+end
+
+local seeds = 10
+local save_file, compare_file
+for _, arg in ipairs(crawl.script_args()) do
+  local _, _, file = string.find(arg, "^-save=(.+)")
+  if file then
+    save_file = file
+  end
+  _, _, file = string.find(arg, "^-compare=(.+)")
+  if file then
+    compare_file = file
+  end
+  local _, _, n = string.find(arg, "^-seeds=(%d+)")
+  if n then
+    seeds = tonumber(n)
+  end
+end
+
+local phases = { "layout", "vaults", "monsters", "items", "connectivity" }
+local columns = { "total", "vetoes" }
+util.append(columns, phases)
+
+local function time_place(place)
+  debug.reset_levelgen_timings()
+  for seed = 1, seeds do
+    debug.reset_rng(seed)
+    debug.goto_place(place)
+    test.regenerate_level()
+  end
+  return debug.levelgen_timings()
+end
+
+local function format_row(place, timings)
+  local row = { place }
+  for _, col in ipairs(columns) do
+    table.insert(row, string.format(col == "vetoes" and "%d" or "%.2f",
+                                    timings[col]))
+  end
+  return table.concat(row, "\t")
+end
+
+local function read_baseline(name)
+  local text = file.readfile(name)
+  if not text then
+    error("Can't read baseline " .. name)
+  end
+  local baseline = { }
+  for line in string.gmatch(text, "[^\n]+") do
+    local fields = crawl.split(line, "\t")
+    if fields[1] ~= "place" then
+      local timings = { }
+      for i, col in ipairs(columns) do
+        timings[col] = tonumber(fields[i + 1])
+      end
+      baseline[fields[1]] = timings
+    end
+  end
+  return baseline
+end
+
+local header = "place\t" .. table.concat(columns, "\t")
+local rows = { header }
+local results = { }
+crawl.stderr(string.format("%d seeds per place, times in ms", seeds))
+crawl.stderr(header)
+for _, place in ipairs(places) do
+  local timings = time_place(place)
+  results[place] = timings
+  local row = format_row(place, timings)
+  table.insert(rows, row)
+  crawl.stderr(row)
+end
+
+if save_file then
+  if not file.writefile(save_file, table.concat(rows, "\n") .. "\n") then
+    error("Can't write baseline " .. save_file)
+  end
+  crawl.stderr("Saved baseline to " .. save_file)
+end
+
+if compare_file then
+  local baseline = read_baseline(compare_file)
+  local regressions = 0
+  for _, place in ipairs(places) do
+    local old, new = baseline[place], results[place]
+    if not old then
+      crawl.stderr(place .. ": not in baseline")
+    else
+      local change = (new.total - old.total) * 100 / math.max(old.total, 1)
+      local notes = { }
+      if change > 20 then
+        table.insert(notes, "SLOWER")
+      end
+      if new.vetoes ~= old.vetoes then
+        table.insert(notes, string.format("vetoes %d -> %d", old.vetoes,
+                                          new.vetoes))
+      end
+      crawl.stderr(string.format("%s: %.2f -> %.2f ms (%+.1f%%) %s", place,
+                                 old.total, new.total, change,
+                                 table.concat(notes, ", ")))
+      if #notes > 0 then
+        regressions = regressions + 1
+      end
+    end
+  end
+  if regressions > 0 then
+    error(regressions .. " place(s) differ from the baseline")
+  end
+end
@@ -0,0 +1,48 @@
+-- Times the two heaviest users of the dungeon Lua state: reading every map
+-- definition, and generating a whole dungeon the way full pregeneration
+-- does. After each it prints the Lua allocation counts, so a run on a build
+-- with a different allocator shows both where the time went and how much
+-- churn there was.
+--
+-- Usage: crawl -script bench-lua-alloc [<map reads>] [<seed>]
+
+crawl_require('dlua/explorer.lua')
+
+local args = script.simple_args()
+local reads = tonumber(args[1]) or 3
+local seed = tonumber(args[2]) or 1
+
+local function report(what, elapsed, before)
+  local after = debug.lua_alloc_stats()
+  local allocs = after.allocs - before.allocs
+  local pooled = after.pooled - before.pooled
+  local resized = after.reallocs - before.reallocs
+  crawl.stderr(string.format(
+    "%s: %d ms, %d allocs, %d reallocs, %d frees, %.1f%% pooled",
+    what, elapsed, allocs, resized, after.frees - before.frees,
+    pooled * 100 / math.max(1, allocs + resized)))
+  crawl.stderr(string.format(
+    "  in use %.1f MB, peak %.1f MB, pool slabs %.1f MB",
+    after.in_use / 1e6, after.peak / 1e6, after.reserved / 1e6))
+end
+
+local before = debug.lua_alloc_stats()
+local start = crawl.millis()
+for i = 1, reads do
+  debug.reread_maps()
+end
+report(string.format("read maps x%d", reads), crawl.millis() - start, before)
+
+before = debug.lua_alloc_stats()
+start = crawl.millis()
+debug.reset_rng(seed)
+dgn.reset_level()
+debug.flush_map_memory()
+debug.dungeon_setup()
+for _, place in ipairs(explorer.generation_order) do
+  if dgn.br_exists(string.match(place, "[^:]+")) then
+    debug.goto_place(place)
+    debug.generate_level()
+  end
+end
+report("seed " .. seed .. " dungeon", crawl.millis() - start, before)
@@ -0,0 +1,36 @@
+-- Times laying out description popups, as happens whenever one is shown or
+-- the window is resized: the longest few entries of a description file one
+-- by one, and then the whole file as a single page.
+--
+-- Usage: crawl -script bench-ui-layout [<passes>] [<description file>]
+
+local args = script.simple_args()
+local passes = tonumber(args[1]) or 300
+local name = args[2] or "dat/descript/monsters.txt"
+
+local text = file.readfile(name)
+if not text then
+  error("Can't read " .. name)
+end
+
+-- Entries are separated by lines of four percent signs.
+local entries = { }
+for _, entry in ipairs(crawl.split(text, "%%%%")) do
+  entry = entry:gsub("^%s+", ""):gsub("%s+$", "")
+  if entry ~= "" then
+    table.insert(entries, entry)
+  end
+end
+table.sort(entries, function (a, b) return #a > #b end)
+
+local function report(what, chars)
+  local elapsed = debug.time_ui_layout(what, passes)
+  crawl.stderr(string.format("%6d chars: %d passes in %.1f ms (%.3f ms/pass)",
+                             chars, passes, elapsed, elapsed / passes))
+  return elapsed
+end
+
+for i = 1, math.min(5, #entries) do
+  report(entries[i], #entries[i])
+end
+report(table.concat(entries, "\n\n"), #text)
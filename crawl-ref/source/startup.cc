@@ -63,6 +63,7 @@
  #include "windowmanager.h"
 #endif
 #include "ui.h"
+#include "wiz-fsim.h"
 
 using namespace ui;
 
@@ -170,6 +171,21 @@ static void _initialize()
     }
 #endif
 
+    if (!crawl_state.arena_batch.empty())
+    {
+        release_cli_signals();
+        run_arena_batch(crawl_state.arena_batch); // this is NORETURN
+    }
+
+#ifdef WIZARD
+    if (!crawl_state.fsim_batch.empty())
+    {
+        release_cli_signals();
+        // this is NORETURN
+        run_fsim_batch(crawl_state.fsim_batch, crawl_state.fsim_jobs);
+    }
+#endif
+
     if (!crawl_state.test_list)
     {
         if (!crawl_state.io_inited)
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
+#include <iterator>
 #include <sstream>
 
 #include "chardump.h"
@@ -23,6 +24,7 @@
 #include "env.h"
 #include "files.h"
 #include "feature.h"
+#include "food.h"
 #include "god-passive.h"
 #include "hints.h"
 #include "invent.h"
@@ -169,7 +171,7 @@ static void _fully_identify_item(item_def *item)
 // Stash
 // ----------------------------------------------------------------------
 
-Stash::Stash(coord_def pos_) : items()
+Stash::Stash(coord_def pos_) : items(), search_dirty(true)
 {
     // First, fix what square we're interested in
     if (pos_.origin())
@@ -239,11 +241,14 @@ bool Stash::unmark_trapping_nets()
     for (auto &item : items)
         if (item_is_stationary_net(item))
             item.net_placed = false, changed = true;
+    search_dirty |= changed;
     return changed;
 }
 
 void Stash::update()
 {
+    search_dirty = true;
+
     feat = grd(pos);
     trap = NUM_TRAPS;
 
@@ -399,6 +404,57 @@ vector<stash_search_result> Stash::matches_search(
     return results;
 }
 
+// Adds the lowercased runs of letters and digits in text to words. Any
+// plain text search (which is case-insensitive) that matches text has to
+// match some of these, and can't run across anything else.
+static void _add_search_words(set<string> &words, const string &text)
+{
+    const string lower = lowercase_string(text);
+    for (size_t start = 0; start < lower.length(); )
+    {
+        size_t end = start;
+        while (end < lower.length() && isaalnum(lower[end]))
+            ++end;
+
+        if (end > start)
+            words.insert(lower.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+bool Stash::search_words(set<string> &words) const
+{
+    for (const item_def &item : items)
+    {
+        // Spell ranges depend on the caster's skills.
+        if (item.has_spells())
+            return false;
+
+        // The stock annotation depends only on the item, on what's been
+        // identified, and on the few things about the player that
+        // _search_player_state() tracks. Searches don't use the index at
+        // all while an rc file has replaced it.
+        _add_search_words(words,
+                          userdef_annotate_item(STASH_LUA_SEARCH_ANNOTATE,
+                                                &item));
+        if (item.quantity > 1)
+            _add_search_words(words, item.name(DESC_QUALNAME));
+
+        _add_search_words(words, stash_item_name(item));
+        // Rotting goes on whether or not we see the stash again.
+        if (_is_rottable(item))
+            _add_search_words(words, "(gone by now) (skeletalised by now)");
+
+        if (is_dumpable_artefact(item))
+            _add_search_words(words, chardump_desc(item));
+    }
+
+    if (feat != DNGN_FLOOR)
+        _add_search_words(words, feature_description());
+
+    return true;
+}
+
 /// Fedhas: rot away all corpses.
 void Stash::rot_all_corpses()
 {
@@ -434,8 +490,10 @@ void Stash::_update_identification()
 {
     for (int i = items.size() - 1; i >= 0; i--)
     {
+        const iflags_t flags = items[i].flags;
         passive_id_item(items[i]);
         maybe_identify_base_type(items[i]);
+        search_dirty |= items[i].flags != flags;
     }
 }
 
@@ -448,6 +506,7 @@ void Stash::add_item(const item_def &item, bool add_to_front)
         items.insert(items.begin(), item);
     else
         items.push_back(item);
+    search_dirty = true;
 
     seen_item(item);
 
@@ -549,6 +608,7 @@ void Stash::load(reader& inf)
 
     uint8_t flags = unmarshallUByte(inf);
     verified = (flags & 1) != 0;
+    search_dirty = true;
 
     // Zap out item vector, in case it's in use (however unlikely)
     items.clear();
@@ -836,6 +896,162 @@ void LevelStashes::_waypoint_search(
     }
 }
 
+void LevelStashes::_mark_search_dirty() const
+{
+    for (const auto &entry : m_stashes)
+        entry.second.search_dirty = true;
+}
+
+// Refile the stashes that have changed since the last search, and forget
+// those that have gone. Both maps are in the same order, so one pass does.
+void LevelStashes::_update_search_index() const
+{
+    auto unindex = [this](stash_words_t::iterator it)
+    {
+        for (const string &word : it->second)
+        {
+            auto filed = m_search_index.find(word);
+            filed->second.erase(it->first);
+            if (filed->second.empty())
+                m_search_index.erase(filed);
+        }
+        m_unindexed.erase(it->first);
+        return m_search_words.erase(it);
+    };
+
+    auto indexed = m_search_words.begin();
+    for (const auto &entry : m_stashes)
+    {
+        while (indexed != m_search_words.end() && indexed->first < entry.first)
+            indexed = unindex(indexed);
+
+        const Stash &stash = entry.second;
+        if (indexed != m_search_words.end() && indexed->first == entry.first)
+        {
+            if (!stash.search_dirty)
+            {
+                ++indexed;
+                continue;
+            }
+            indexed = unindex(indexed);
+        }
+
+        set<string> &words = m_search_words[entry.first];
+        if (!stash.search_words(words))
+        {
+            words.clear();
+            m_unindexed.insert(entry.first);
+        }
+        for (const string &word : words)
+            m_search_index[word].insert(entry.first);
+        stash.search_dirty = false;
+    }
+
+    while (indexed != m_search_words.end())
+        indexed = unindex(indexed);
+}
+
+// Whether the search annotation hook is still the stock one from
+// clua/stash.lua, whose inputs the index knows to watch.
+static bool _stock_search_annotation()
+{
+#ifdef CLUA_BINDINGS
+    lua_stack_cleaner cleaner(clua);
+    lua_getglobal(clua, STASH_LUA_SEARCH_ANNOTATE);
+    lua_getglobal(clua, "stock_" STASH_LUA_SEARCH_ANNOTATE);
+    return lua_isfunction(clua, -1) && lua_rawequal(clua, -1, -2);
+#else
+    return true;
+#endif
+}
+
+// Narrow a plain text search down to the stashes that have all of its words
+// (or at least ones that could contain them, for the words at either end
+// of it). Returns false if the search can't be narrowed down.
+bool LevelStashes::_search_candidates(const base_pattern &search,
+                                      const string &lplace,
+                                      set<coord_def> &candidates) const
+{
+    if (!dynamic_cast<const plaintext_pattern *>(&search)
+        || !_stock_search_annotation())
+    {
+        return false;
+    }
+
+    _update_search_index();
+
+    // Words every stash's search text has, whatever is in it.
+    set<string> everywhere;
+    _add_search_words(everywhere, lplace);
+    if (Options.autopickup_search)
+        _add_search_words(everywhere, "{autopickup}");
+
+    const string text = lowercase_string(search.tostring());
+    bool narrowed = false;
+    for (size_t start = 0; start < text.length(); )
+    {
+        size_t end = start;
+        while (end < text.length() && isaalnum(text[end]))
+            ++end;
+
+        if (end == start)
+        {
+            ++start;
+            continue;
+        }
+
+        // A word with something other than a letter or digit on either
+        // side of it in the search has to be the start or end of a word in
+        // the stash too.
+        const string word = text.substr(start, end - start);
+        const bool whole_start = start > 0;
+        const bool whole_end = end < text.length();
+        start = end;
+
+        auto fits = [&](const string &stash_word)
+        {
+            const size_t at = whole_end
+                ? stash_word.length() - min(stash_word.length(), word.length())
+                : 0;
+            const size_t found = stash_word.find(word, at);
+            return found != string::npos
+                   && (!whole_start || found == 0)
+                   && (!whole_end || found + word.length()
+                                     == stash_word.length());
+        };
+
+        if (any_of(everywhere.begin(), everywhere.end(), fits))
+            continue;
+
+        set<coord_def> with_word;
+        auto first = whole_start ? m_search_index.lower_bound(word)
+                                 : m_search_index.begin();
+        for (auto it = first; it != m_search_index.end(); ++it)
+        {
+            if (whole_start && !starts_with(it->first, word))
+                break;
+            if (fits(it->first))
+                with_word.insert(it->second.begin(), it->second.end());
+        }
+
+        if (!narrowed)
+            candidates = with_word;
+        else
+        {
+            set<coord_def> both;
+            set_intersection(candidates.begin(), candidates.end(),
+                             with_word.begin(), with_word.end(),
+                             inserter(both, both.end()));
+            candidates.swap(both);
+        }
+        narrowed = true;
+    }
+
+    if (narrowed)
+        candidates.insert(m_unindexed.begin(), m_unindexed.end());
+    return narrowed;
+}
+
 void LevelStashes::get_matching_stashes(
         const base_pattern &search,
         vector<stash_search_result> &results) const
@@ -856,8 +1072,13 @@ void LevelStashes::get_matching_stashes(
         return;
     }
 
+    set<coord_def> candidates;
+    const bool narrowed = _search_candidates(search, lplace, candidates);
     for (const auto &entry : m_stashes)
     {
+        if (narrowed && !candidates.count(entry.first))
+            continue;
+
         vector<stash_search_result> new_results =
             entry.second.matches_search(lplace, search);
         for (auto &res : new_results)
@@ -1487,12 +1708,38 @@ void StashTracker::search_stashes(string search_term)
     }
 }
 
+// What the stock search annotation asks about the player: whether they can
+// throw an item and how many hands a weapon takes them both go by their
+// size, and what they'd like to eat by what they are.
+static vector<int> _search_player_state()
+{
+    return { you.body_size(), you_foodless(),
+             you.get_mutation_level(MUT_ROTTING_BODY),
+             you.get_mutation_level(MUT_CARNIVOROUS) };
+}
+
 void StashTracker::get_matching_stashes(
         const base_pattern &search,
         vector<stash_search_result> &results,
         bool curr_lev)
     const
 {
+    // Identifying an item type renames every item of that type, and a
+    // change of size, form or diet can change every item's annotation.
+    bool stale = false;
+    for (int i = 0; i < NUM_OBJECT_CLASSES; ++i)
+        for (int j = 0; j < MAX_SUBTYPES; ++j)
+            stale |= you.type_ids[i][j] != search_type_ids[i][j];
+    vector<int> player_state = _search_player_state();
+    stale |= player_state != search_player_state;
+    if (stale)
+    {
+        for (const auto &entry : levels)
+            entry.second._mark_search_dirty();
+        search_type_ids = you.type_ids;
+        search_player_state = move(player_state);
+    }
+
     level_id curr = level_id::current();
     for (const auto &entry : levels)
     {
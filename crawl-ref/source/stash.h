@@ -6,6 +6,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -64,6 +65,12 @@ public:
 
     bool is_verified() const {  return verified; }
 
+    // Adds the words any plain text search matching this stash has to
+    // touch, leaving out the level name and the autopickup annotation.
+    // Returns false if some of its search text can change without the
+    // stash itself changing, so it can't be indexed.
+    bool search_words(set<string> &words) const;
+
 private:
     void _update_corpses(int rot_time);
     void _update_identification();
@@ -78,6 +85,9 @@ private:
 
     vector<item_def> items;
 
+    // Has this changed since LevelStashes last indexed its search words?
+    mutable bool search_dirty;
+
     static bool are_items_same(const item_def &, const item_def &,
                                bool exact = false);
 
@@ -224,15 +234,28 @@ private:
     void _update_corpses(int rot_time);
     void _update_identification();
     void _waypoint_search(int n, vector<stash_search_result> &results) const;
+    void _mark_search_dirty() const;
+    void _update_search_index() const;
+    bool _search_candidates(const base_pattern &search, const string &lplace,
+                            set<coord_def> &candidates) const;
 
     typedef map<coord_def, Stash> stashes_t;
     typedef vector<ShopInfo> shops_t;
+    typedef map<coord_def, set<string>> stash_words_t;
 
     // which level
     level_id m_place;
     stashes_t m_stashes;
     shops_t m_shops;
 
+    // The search index, brought up to date at the start of each search:
+    // which stashes have each word in their search text, and which words
+    // each stash was filed under. Stashes that can't be indexed are always
+    // searched.
+    mutable map<string, set<coord_def>> m_search_index;
+    mutable stash_words_t m_search_words;
+    mutable set<coord_def> m_unindexed;
+
     friend class StashTracker;
     friend class ST_ItemIterator;
 };
@@ -242,6 +265,7 @@ class StashTracker
 public:
     StashTracker() : levels(), last_corpse_update(0)
     {
+        search_type_ids.init(false);
     }
 
     void search_stashes(string search_term = "");
@@ -299,6 +323,12 @@ private:
 
     int last_corpse_update;
 
+    // Item type knowledge as of the last search: item names depend on it,
+    // so the search indices are stale once it changes. Likewise for what
+    // the search annotations know about the player.
+    mutable id_arr search_type_ids;
+    mutable vector<int> search_player_state;
+
     friend class ST_ItemIterator;
 };
 
@@ -65,6 +65,11 @@ struct game_state
 
     string force_map;       // Set if we're forcing a specific map to generate.
 
+    string arena_batch;     // Set to a file of matchups to fight headlessly.
+    string fsim_batch;      // Set to a file of fight simulations to run.
+    int    fsim_jobs;       // How many processes to run them in (0 = a core
+                            // each).
+
     game_type type;
     game_type last_type;
     game_ended_condition last_game_exit;
@@ -58,8 +58,8 @@
 #include "mapmark.h"
 #include "misc.h"
 #include "mon-death.h"
+#include "mon-place.h"
 #if TAG_MAJOR_VERSION == 34
- #include "mon-place.h"
  #include "mon-poly.h"
  #include "mon-tentacle.h"
  #include "mon-util.h"
@@ -6103,6 +6103,8 @@ static void tag_read_level_items(reader &th)
         }
     }
 #endif
+
+    rebuild_item_free_list();
 }
 
 void unmarshallMonster(reader &th, monster& m)
@@ -6659,6 +6661,8 @@ static void tag_read_level_monsters(reader &th)
 #endif
         mgrd(m.pos()) = i;
     }
+
+    rebuild_monster_free_list();
 }
 
 static void _debug_count_tiles()
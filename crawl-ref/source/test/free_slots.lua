@@ -0,0 +1,22 @@
+-- Checks that the item and monster free lists hand out the same slots as
+-- walking the tables from the start would, so that slot numbers (and
+-- everything that goes by them) are the same as before there were lists.
+
+crawl_require('dlua/explorer.lua')
+
+local seeds = { 1, 2 }
+local max_depth = 25
+local cats = { "vaults", "items", "features", "monsters" }
+
+local old_quiet = explorer.quiet
+explorer.quiet = true
+debug.check_free_slots(true)
+for _, seed in ipairs(seeds) do
+  explorer.catalog_seed(seed, max_depth, cats,
+                        function () return false end,
+                        function () return "" end)
+end
+local mismatches = debug.check_free_slots(false)
+explorer.quiet = old_quiet
+assert(mismatches == 0, "Free lists handed out " .. mismatches
+                        .. " slot(s) other than the lowest free one")
@@ -0,0 +1,38 @@
+-- Checks that the cached monster pick tables pick exactly what working out
+-- the rarities every time does: the same seeds should generate the same
+-- dungeon with them on and off.
+
+crawl_require('dlua/explorer.lua')
+
+local seeds = { 1, 2 }
+local max_depth = 25
+local cats = { "vaults", "items", "features", "monsters" }
+
+local function same(a, b, path)
+  if type(a) ~= "table" or type(b) ~= "table" then
+    assert(a == b, "Dungeons differ at " .. path .. ": "
+                   .. tostring(a) .. " vs " .. tostring(b))
+    return
+  end
+  for k, v in pairs(a) do
+    same(v, b[k], path .. "." .. tostring(k))
+  end
+  for k, v in pairs(b) do
+    same(a[k], v, path .. "." .. tostring(k))
+  end
+end
+
+local function catalog(seed, use_tables)
+  debug.use_pick_tables(use_tables)
+  return explorer.catalog_seed(seed, max_depth, cats,
+                               function () return false end,
+                               function () return "" end)
+end
+
+local old_quiet = explorer.quiet
+explorer.quiet = true
+for _, seed in ipairs(seeds) do
+  same(catalog(seed, true), catalog(seed, false), "seed " .. seed)
+end
+explorer.quiet = old_quiet
+debug.use_pick_tables(true)
@@ -0,0 +1,22 @@
+-- Checks that interlevel travel's stair distances, which come from a single
+-- flood out of all the stairs at once, match those from flooding out of
+-- each stair in turn.
+
+local niters = 3
+local places = { "D:5", "Lair:2", "Vaults:1", "Elf:2", "Zot:1" }
+
+local function test_stair_distances(place)
+  debug.goto_place(place)
+  for i = 1, niters do
+    test.regenerate_level()
+    wiz.map_level()
+    assert(debug.check_stair_distances(),
+           "Stair distances differ at " .. place .. " (try " .. i .. ")")
+  end
+end
+
+if you.wizard then
+  for _, place in ipairs(places) do
+    test_stair_distances(place)
+  end
+end
@@ -0,0 +1,20 @@
+-- Checks that the level builder's one-pass zone labelling finds the same
+-- disconnected zones, numbered the same way, as flood-filling them one at
+-- a time.
+
+local niters = 3
+local places = { "D:2", "D:12", "Lair:3", "Swamp:2", "Shoals:3", "Orc:1",
+                 "Elf:2", "Zot:3" }
+
+local function test_zone_labels(place)
+  debug.goto_place(place)
+  for i = 1, niters do
+    test.regenerate_level()
+    assert(debug.check_zone_labels(),
+           "Zone labels differ at " .. place .. " (try " .. i .. ")")
+  end
+end
+
+for _, place in ipairs(places) do
+  test_zone_labels(place)
+end
@@ -0,0 +1,227 @@
+#include "AppHdr.h"
+
+#ifdef USE_TILE_WEB
+
+#include "tileweb-ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char RING_MAGIC[8] = { 'C', 'R', 'A', 'W', 'L', 'R', 'B', '1' };
+static const size_t RING_DATA_OFFSET = 64;
+static const size_t RECORD_HEADER_SIZE = 12;
+
+enum ring_reader_state
+{
+    RING_READER_PENDING,
+    RING_READER_ATTACHED,
+    RING_READER_GONE,
+};
+
+// Give up on a reader that hasn't made room for this long.
+static const int RING_STALL_LIMIT_MS = 30 * 1000;
+
+static uint64_t _now_usec()
+{
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+WebtilesRing::WebtilesRing()
+    : m_ring_fd(-1), m_bell_fd(-1), m_map_size(0), m_header(nullptr),
+      m_data(nullptr)
+{
+    COMPILE_CHECK(sizeof(header) <= RING_DATA_OFFSET);
+}
+
+WebtilesRing::~WebtilesRing()
+{
+    close();
+}
+
+bool WebtilesRing::create(const string &base, size_t capacity)
+{
+    close();
+
+    size_t size = 4096;
+    while (size < capacity)
+        size *= 2;
+
+    m_ring_path = base + ".ring";
+    m_bell_path = base + ".bell";
+    unlink(m_ring_path.c_str());
+    unlink(m_bell_path.c_str());
+
+    m_ring_fd = open(m_ring_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                     0600);
+    if (m_ring_fd < 0 || ftruncate(m_ring_fd, RING_DATA_OFFSET + size) < 0)
+    {
+        close();
+        return false;
+    }
+
+    m_map_size = RING_DATA_OFFSET + size;
+    void *map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     m_ring_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    m_header = new (map) header;
+    m_data = static_cast<char *>(map) + RING_DATA_OFFSET;
+
+    // Opening a fifo read-write never blocks and never fails for want of a
+    // reader (on Linux), so writes can't raise SIGPIPE before the server
+    // opens its end, or after it closes it.
+    if (mkfifo(m_bell_path.c_str(), 0600) < 0
+        || (m_bell_fd = open(m_bell_path.c_str(),
+                             O_RDWR | O_NONBLOCK | O_CLOEXEC)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    m_header->capacity = size;
+    m_header->reader_state.store(RING_READER_PENDING);
+    m_header->head.store(0);
+    m_header->tail.store(0);
+    // The magic goes in last, so a reader never sees a half-set-up ring.
+    atomic_thread_fence(memory_order_release);
+    memcpy(m_header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+    return true;
+}
+
+void WebtilesRing::close()
+{
+    if (m_header)
+        munmap(m_header, m_map_size);
+    if (m_ring_fd >= 0)
+    {
+        ::close(m_ring_fd);
+        unlink(m_ring_path.c_str());
+    }
+    if (m_bell_fd >= 0)
+        ::close(m_bell_fd);
+    if (!m_bell_path.empty())
+        unlink(m_bell_path.c_str());
+
+    m_ring_fd = m_bell_fd = -1;
+    m_header = nullptr;
+    m_data = nullptr;
+    m_map_size = 0;
+    m_ring_path.clear();
+    m_bell_path.clear();
+}
+
+void WebtilesRing::_copy_in(uint64_t pos, const char *data, size_t size)
+{
+    const size_t capacity = m_header->capacity;
+    const size_t start = pos & (capacity - 1);
+    const size_t first = min(size, capacity - start);
+    memcpy(m_data + start, data, first);
+    memcpy(m_data, data + first, size - first);
+}
+
+// Back off for a while, dying if the reader has been stuck for too long.
+// Returns false if the reader went away instead.
+bool WebtilesRing::_pause(int &waited_us, int &sleep_us)
+{
+    if (m_header->reader_state.load() == RING_READER_GONE)
+        return false;
+    if (waited_us >= RING_STALL_LIMIT_MS * 1000)
+        die("Webtiles ring reader stalled for %d ms", waited_us / 1000);
+
+    usleep(sleep_us);
+    waited_us += sleep_us;
+    sleep_us = min(sleep_us * 2, 10 * 1000);
+    return true;
+}
+
+// Tell the reader that everything up to head is there. The reader takes
+// head from the doorbell rather than from the header: passing it through
+// the pipe makes our writes to the ring visible to its reads on every
+// architecture, which a plain load of the header field wouldn't. So every
+// head has to get through, even if that means waiting for the pipe to
+// drain.
+bool WebtilesRing::_ring_bell(uint64_t head)
+{
+    int waited_us = 0;
+    int sleep_us = 100;
+    while (::write(m_bell_fd, &head, sizeof(head)) != sizeof(head))
+    {
+        if (errno != EAGAIN && errno != EINTR)
+            return false;
+        if (!_pause(waited_us, sleep_us))
+            return false;
+    }
+    return true;
+}
+
+// Wait until the reader has left room for at least one more byte after
+// head. Whatever was written up to head is published first: a record bigger
+// than the ring only gets through if the reader sees it piece by piece.
+// Returns false if the reader went away instead.
+bool WebtilesRing::_wait_for_space(uint64_t head)
+{
+    if (head - m_header->tail.load(memory_order_acquire) < m_header->capacity)
+        return true;
+
+    m_header->head.store(head, memory_order_release);
+    if (!_ring_bell(head))
+        return false;
+
+    int waited_us = 0;
+    int sleep_us = 100;
+    while (head - m_header->tail.load(memory_order_acquire)
+           >= m_header->capacity)
+    {
+        if (!_pause(waited_us, sleep_us))
+            return false;
+    }
+    return true;
+}
+
+bool WebtilesRing::write(const char *data, size_t size)
+{
+    ASSERT(is_open());
+    if (m_header->reader_state.load() == RING_READER_GONE)
+        return false;
+
+    char record[RECORD_HEADER_SIZE];
+    const uint32_t len = size;
+    const uint64_t sent = _now_usec();
+    memcpy(record, &len, sizeof(len));
+    memcpy(record + sizeof(len), &sent, sizeof(sent));
+
+    uint64_t head = m_header->head.load(memory_order_relaxed);
+    const char *parts[] = { record, data };
+    const size_t part_sizes[] = { sizeof(record), size };
+    for (int i = 0; i < 2; ++i)
+    {
+        size_t done = 0;
+        while (done < part_sizes[i])
+        {
+            if (!_wait_for_space(head))
+                return false;
+            const uint64_t room = m_header->capacity
+                - (head - m_header->tail.load(memory_order_acquire));
+            const size_t chunk = min<uint64_t>(room, part_sizes[i] - done);
+            _copy_in(head, parts[i] + done, chunk);
+            done += chunk;
+            head += chunk;
+        }
+    }
+    m_header->head.store(head, memory_order_release);
+    return _ring_bell(head);
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Shared-memory transport for webtiles messages.
+ *
+ * A single-producer, single-consumer byte ring in a file that both crawl
+ * and the webtiles server map, with a named pipe next to it as doorbell.
+ * Crawl writes each message into the ring as one record and rings the
+ * doorbell by writing the new head to it as a uint64; the server reads up
+ * to the latest head it got from the pipe whenever the pipe becomes
+ * readable. Unlike the datagram socket, messages are never
+ * fragmented and there is no kernel send buffer to run out of.
+ *
+ * Ring file layout (all integers little-endian, as on every host webtiles
+ * runs on):
+ *
+ *   0  char[8]  magic, "CRAWLRB1"
+ *   8  uint32   capacity of the data area in bytes (a power of two)
+ *   12 uint32   reader state: 0 not attached yet, 1 attached, 2 gone
+ *   16 uint64   head: bytes ever written, only advanced by crawl (the
+ *               reader goes by the doorbell instead)
+ *   24 uint64   tail: bytes ever read, only advanced by the server
+ *   64          data area
+ *
+ * Each record is a uint32 payload length, a uint64 send time in
+ * microseconds since the epoch (for latency measurements), and then the
+ * payload itself, wrapping around the end of the data area as needed. A
+ * record larger than the ring is simply written in pieces as the reader
+ * makes room.
+ *
+ * See webserver/shm_ring.py for the reading end.
+**/
+
+#ifdef USE_TILE_WEB
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class WebtilesRing
+{
+public:
+    WebtilesRing();
+    ~WebtilesRing();
+
+    // Create the ring file <base>.ring and the doorbell <base>.bell, with
+    // room for capacity bytes (rounded up to a power of two). Returns false
+    // and leaves nothing behind if either can't be created.
+    bool create(const string &base, size_t capacity);
+    void close();
+    bool is_open() const { return m_header != nullptr; }
+
+    // Append one message and ring the doorbell. Waits while the ring is
+    // full; returns false if the reader has gone away.
+    bool write(const char *data, size_t size);
+
+    const string &ring_path() const { return m_ring_path; }
+    const string &bell_path() const { return m_bell_path; }
+
+private:
+    struct header
+    {
+        char magic[8];
+        uint32_t capacity;
+        atomic<uint32_t> reader_state;
+        atomic<uint64_t> head;
+        atomic<uint64_t> tail;
+    };
+
+    bool _pause(int &waited_us, int &sleep_us);
+    bool _ring_bell(uint64_t head);
+    bool _wait_for_space(uint64_t head);
+    void _copy_in(uint64_t pos, const char *data, size_t size);
+
+    string m_ring_path;
+    string m_bell_path;
+    int m_ring_fd;
+    int m_bell_fd;
+    size_t m_map_size;
+    header *m_header;
+    char *m_data;
+};
+
+#endif
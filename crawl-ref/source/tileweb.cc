@@ -65,6 +65,11 @@
 
 //#define DEBUG_WEBSOCKETS
 
+// Size of the shared-memory ring for each receiver that asks for one.
+static const size_t WEBTILES_RING_SIZE = 1024 * 1024;
+// Send queued messages early once there are this many bytes of them.
+static const size_t WEBTILES_BATCH_LIMIT = 256 * 1024;
+
 static unsigned int get_milliseconds()
 {
     // This is Unix-only, but so is Webtiles at the moment.
@@ -77,6 +82,8 @@ static unsigned int get_milliseconds()
 TilesFramework tiles;
 
 TilesFramework::TilesFramework() :
+      m_rings_created(0),
+      m_send_stats(),
       m_controlled_from_web(false),
       _send_lock(false),
       m_last_ui_state(UI_INIT),
@@ -106,6 +113,8 @@ void TilesFramework::shutdown()
     if (m_sock_name.empty())
         return;
 
+    _send_batch();
+    m_receivers.clear();
     close(m_sock);
     remove(m_sock_name.c_str());
 }
@@ -185,8 +194,7 @@ void TilesFramework::finish_message()
     if (m_msg_buf.size() == 0)
         return;
 #ifdef DEBUG_WEBSOCKETS
-    const int initial_buf_size = m_msg_buf.size();
-    fprintf(stderr, "websocket: About to send %d bytes.\n", initial_buf_size);
+    fprintf(stderr, "websocket: Queued %d bytes.\n", (int) m_msg_buf.size());
 #endif
 
     if (m_sock_name.empty())
@@ -196,82 +204,182 @@ void TilesFramework::finish_message()
     }
 
     m_msg_buf.append("\n");
-    const char* fragment_start = m_msg_buf.data();
-    const char* data_end = m_msg_buf.data() + m_msg_buf.size();
-    int fragments = 0;
+    m_batch_buf.append(m_msg_buf);
+    m_batch_ends.push_back(m_batch_buf.size());
+    m_msg_buf.clear();
+    m_need_flush = true;
+
+    // Don't let a long stretch without input pile up without limit.
+    if (m_batch_buf.size() >= WEBTILES_BATCH_LIMIT)
+        _send_batch();
+}
+
+// Send everything queued since the last batch: all of it in one go to
+// receivers that split batches themselves, one message at a time to the
+// rest.
+void TilesFramework::_send_batch()
+{
+    if (m_batch_buf.empty())
+        return;
+
+    for (unsigned int i = 0; i < m_receivers.size(); ++i)
+    {
+        Receiver &receiver = m_receivers[i];
+        bool alive = true;
+        if (receiver.batches)
+        {
+            alive = _send_to_receiver(receiver, m_batch_buf.data(),
+                                      m_batch_buf.size());
+        }
+        else
+        {
+            size_t start = 0;
+            for (size_t end : m_batch_ends)
+            {
+                alive = _send_to_receiver(receiver, m_batch_buf.data() + start,
+                                          end - start);
+                if (!alive)
+                    break;
+                start = end;
+            }
+        }
+
+        if (!alive)
+        {
+            m_receivers.erase(m_receivers.begin() + i);
+            i--;
+        }
+    }
+
+#ifdef DEBUG_WEBSOCKETS
+    fprintf(stderr, "websocket: Sent %d messages, %d bytes to %d receivers.\n",
+            (int) m_batch_ends.size(), (int) m_batch_buf.size(),
+            (int) m_receivers.size());
+#endif
+    m_send_stats.messages += m_batch_ends.size();
+    m_send_stats.bytes += m_batch_buf.size();
+    m_batch_buf.clear();
+    m_batch_ends.clear();
+}
+
+bool TilesFramework::_send_to_receiver(Receiver &receiver, const char *data,
+                                       int size)
+{
+    if (!receiver.ring)
+        return _send_to_socket(receiver.addr, data, size);
+
+    // Only the doorbell is a syscall.
+    m_send_stats.syscalls++;
+    return receiver.ring->write(data, size);
+}
+
+void TilesFramework::_report_send_stats()
+{
+    if (Options.tile_web_send_stats && m_send_stats.messages)
+    {
+        fprintf(stderr, "webtiles: %d messages, %d syscalls, %u bytes\n",
+                m_send_stats.messages, m_send_stats.syscalls,
+                (unsigned int) m_send_stats.bytes);
+    }
+    m_send_stats = SendStats();
+}
+
+// Send one message to a receiver over the socket, split into fragments of
+// at most m_max_msg_size bytes. Returns false if the receiver is gone.
+bool TilesFramework::_send_to_socket(const sockaddr_un &addr,
+                                     const char *data, int size)
+{
+    const char* fragment_start = data;
+    const char* data_end = data + size;
     while (fragment_start < data_end)
     {
         int fragment_size = data_end - fragment_start;
         if (fragment_size > m_max_msg_size)
             fragment_size = m_max_msg_size;
-        fragments++;
 
-        for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+        int retries = 30;
+        ssize_t sent = 0;
+        while (sent < fragment_size)
         {
-            int retries = 30;
-            ssize_t sent = 0;
-            while (sent < fragment_size)
-            {
-                ssize_t retval = sendto(m_sock, fragment_start + sent,
-                    fragment_size - sent, 0, (sockaddr*) &m_dest_addrs[i],
-                    sizeof(sockaddr_un));
+            m_send_stats.syscalls++;
+            ssize_t retval = sendto(m_sock, fragment_start + sent,
+                fragment_size - sent, 0, (sockaddr*) &addr,
+                sizeof(sockaddr_un));
 #ifdef DEBUG_WEBSOCKETS
-                fprintf(stderr,
-                            "    trying to send fragment to client %d...", i);
+            fprintf(stderr, "    trying to send fragment to %s...",
+                            addr.sun_path);
 #endif
-                if (retval <= 0)
-                {
-                    const char *errmsg = retval == 0 ? "No bytes sent"
-                                                     : strerror(errno);
-                    if (--retries <= 0)
-                        die("Socket write error: %s", errmsg);
+            if (retval <= 0)
+            {
+                const char *errmsg = retval == 0 ? "No bytes sent"
+                                                 : strerror(errno);
+                if (--retries <= 0)
+                    die("Socket write error: %s", errmsg);
 
-                    if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
-                        || errno == EINTR || errno == EAGAIN)
-                    {
-                        // Wait for half a second at first (up to five), then
-                        // try again.
-                        const int sleep_time = retries > 25 ? 2 * 1000
-                                             : retries > 10 ? 500 * 1000
-                                             : 5000 * 1000;
+                if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
+                    || errno == EINTR || errno == EAGAIN)
+                {
+                    // Wait for half a second at first (up to five), then
+                    // try again.
+                    const int sleep_time = retries > 25 ? 2 * 1000
+                                         : retries > 10 ? 500 * 1000
+                                         : 5000 * 1000;
 #ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr, "failed (%s), sleeping for %dms.\n",
-                                                    errmsg, sleep_time / 1000);
+                    fprintf(stderr, "failed (%s), sleeping for %dms.\n",
+                                                errmsg, sleep_time / 1000);
 #endif
-                        usleep(sleep_time);
-                    }
-                    else if (errno == ECONNREFUSED || errno == ENOENT)
-                    {
-                        // the other side is dead
+                    usleep(sleep_time);
+                }
+                else if (errno == ECONNREFUSED || errno == ENOENT)
+                {
+                    // the other side is dead
 #ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr,
-                            "failed (%s), breaking.\n", errmsg);
+                    fprintf(stderr, "failed (%s), breaking.\n", errmsg);
 #endif
-                        m_dest_addrs.erase(m_dest_addrs.begin() + i);
-                        i--;
-                        break;
-                    }
-                    else
-                        die("Socket write error: %s", errmsg);
+                    return false;
                 }
                 else
-                {
+                    die("Socket write error: %s", errmsg);
+            }
+            else
+            {
 #ifdef DEBUG_WEBSOCKETS
-                    fprintf(stderr, "fragment size %d sent.\n", fragment_size);
+                fprintf(stderr, "fragment size %d sent.\n", fragment_size);
 #endif
-                    sent += retval;
-                }
+                sent += retval;
             }
         }
 
         fragment_start += fragment_size;
     }
-    m_msg_buf.clear();
-    m_need_flush = true;
-#ifdef DEBUG_WEBSOCKETS
-    fprintf(stderr, "websocket: Sent %d bytes in %d fragments.\n",
-                                                initial_buf_size, fragments);
-#endif
+    return true;
+}
+
+// A receiver asked to read its messages from shared memory instead of the
+// socket. Set up a ring for it and tell it where to find it; the offer is
+// the last thing it gets over the socket, so nothing can arrive out of
+// order. If the ring can't be made it just stays on the socket.
+void TilesFramework::_offer_ring(Receiver &receiver)
+{
+    const string base = make_stringf("%s.%d", m_sock_name.c_str(),
+                                     ++m_rings_created);
+    // The paths go into JSON unescaped.
+    if (base.find_first_of("\"\\") != string::npos)
+        return;
+
+    unique_ptr<WebtilesRing> ring(new WebtilesRing);
+    if (!ring->create(base, WEBTILES_RING_SIZE))
+    {
+        dprf("Couldn't create a webtiles ring at %s: %s", base.c_str(),
+             strerror(errno));
+        return;
+    }
+
+    const string offer = make_stringf(
+        "*{\"msg\":\"shm_transport\",\"ring\":\"%s\",\"bell\":\"%s\"}\n",
+        ring->ring_path().c_str(), ring->bell_path().c_str());
+    if (_send_to_socket(receiver.addr, offer.data(), offer.size()))
+        receiver.ring = move(ring);
 }
 
 void TilesFramework::send_message(const char *format, ...)
@@ -307,6 +415,7 @@ void TilesFramework::flush_messages()
         send_message("*{\"msg\":\"flush_messages\"}");
         m_need_flush = false;
     }
+    _send_batch();
 }
 
 void TilesFramework::_await_connection()
@@ -314,7 +423,7 @@ void TilesFramework::_await_connection()
     if (m_sock_name.empty())
         return;
 
-    while (m_dest_addrs.size() == 0)
+    while (m_receivers.empty())
         _receive_control_message();
 }
 
@@ -367,8 +476,23 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         JsonWrapper primary = json_find_member(obj.node, "primary");
         primary.check(JSON_BOOL);
 
-        m_dest_addrs.push_back(addr);
+        // Whatever is queued was meant for the receivers we already had.
+        _send_batch();
+
+        m_receivers.emplace_back();
+        Receiver &receiver = m_receivers.back();
+        receiver.addr = addr;
+        JsonWrapper batches = json_find_member(obj.node, "batch");
+        receiver.batches = batches.node && batches->tag == JSON_BOOL
+                           && batches->bool_;
         m_controlled_from_web = primary->bool_;
+
+        JsonWrapper transport = json_find_member(obj.node, "transport");
+        if (transport.node && transport->tag == JSON_STRING
+            && !strcmp(transport->string_, "shm"))
+        {
+            _offer_ring(receiver);
+        }
     }
     else if (msgtype == "key")
     {
@@ -469,6 +593,7 @@ bool TilesFramework::await_input(wint_t& c, bool block)
             if (block)
             {
                 tiles.flush_messages();
+                _report_send_stats();
                 result = select(maxfd + 1, &fds, nullptr, nullptr, nullptr);
             }
             else
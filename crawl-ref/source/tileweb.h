@@ -9,6 +9,7 @@
 
 #include <bitset>
 #include <map>
+#include <memory>
 #include <sys/un.h>
 
 #include "cursor-type.h"
@@ -19,6 +20,7 @@
 #include "text-tag-type.h"
 #include "tiledoll.h"
 #include "tilemcache.h"
+#include "tileweb-ring.h"
 #include "tileweb-text.h"
 #include "viewgeom.h"
 
@@ -164,7 +166,7 @@ public:
     void send_message(PRINTF(1, ));
     void flush_messages();
 
-    bool has_receivers() { return !m_dest_addrs.empty(); }
+    bool has_receivers() { return !m_receivers.empty(); }
     bool is_controlled_from_web() { return m_controlled_from_web; }
 
     /* Webtiles can receive input both via stdin, and on the
@@ -208,6 +210,8 @@ public:
     void json_treat_as_empty();
     void json_treat_as_nonempty();
     bool json_is_empty();
+    // How much has been written to the current message so far.
+    size_t json_size() const { return m_msg_buf.size(); }
 
     string m_sock_name;
     bool m_await_connection;
@@ -231,7 +235,32 @@ protected:
     int m_sock;
     int m_max_msg_size;
     string m_msg_buf;
-    vector<sockaddr_un> m_dest_addrs;
+    struct Receiver
+    {
+        sockaddr_un addr;
+        // The shared-memory ring it reads messages from, or null if it
+        // still reads them from the socket.
+        unique_ptr<WebtilesRing> ring;
+        // Whether it splits a batch of newline-terminated messages itself.
+        bool batches;
+    };
+    vector<Receiver> m_receivers;
+    int m_rings_created;
+
+    // Messages finished since the last flush, each ending in a newline, and
+    // the offset just past each of them. They all go out together, as one
+    // write per receiver, when the game next waits for input or flushes.
+    string m_batch_buf;
+    vector<size_t> m_batch_ends;
+
+    // What went out since the last input wait, for tile_web_send_stats.
+    struct SendStats
+    {
+        int messages;
+        int syscalls;
+        size_t bytes;
+    };
+    SendStats m_send_stats;
 
     bool m_controlled_from_web;
     bool m_need_flush;
@@ -239,6 +268,11 @@ protected:
     bool _send_lock; // not thread safe
 
     void _await_connection();
+    bool _send_to_socket(const sockaddr_un &addr, const char *data, int size);
+    bool _send_to_receiver(Receiver &receiver, const char *data, int size);
+    void _send_batch();
+    void _report_send_stats();
+    void _offer_ring(Receiver &receiver);
     wint_t _handle_control_message(sockaddr_un addr, string data);
     wint_t _receive_control_message();
 
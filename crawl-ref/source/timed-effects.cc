@@ -839,9 +839,37 @@ void monster::timeout_enchantments(int levels)
     }
 }
 
+/**
+ * Can catching up on the player's absence change this monster at all?
+ *
+ * A sleeping, unhurt monster with no enchantments to time out and no foe to
+ * forget is left exactly as it was by update_monster(), however long the
+ * player was away; and on a level the player left long ago, that's most of
+ * the population.
+ *
+ * @param mon   The monster in question.
+ * @return      Whether update_monster() can be skipped for it.
+ */
+static bool _catchup_is_noop(const monster &mon)
+{
+    return mon.asleep()
+           && mon.enchantments.empty()
+           && mon.hit_points >= mon.max_hit_points
+           && !mon.foe_memory
+           && !mon.pacified()
+           && !(mon.flags & MF_JUST_SUMMONED);
+}
+
 /**
  * Update the level upon the player's return.
  *
+ * Everything here is computed from the elapsed time in one step, rather
+ * than by replaying the missed turns: the level-wide timers (rot, tides,
+ * tombs, terrain changes, gateways, sanctuary) each take the whole duration
+ * at once, and each monster's regeneration, forgetting, movement and
+ * enchantment expiry is a single bounded update. Monsters that the update
+ * can't affect are skipped outright.
+ *
  * @param elapsedTime how long the player was away.
  */
 void update_level(int elapsedTime)
@@ -852,6 +880,7 @@ void update_level(int elapsedTime)
 
 #ifdef DEBUG_DIAGNOSTICS
     int mons_total = 0;
+    int mons_skipped = 0;
 
     dprf("turns: %d", turns);
 #endif
@@ -879,12 +908,20 @@ void update_level(int elapsedTime)
         mons_total++;
 #endif
 
-        if (!update_monster(**mi, turns))
+        if (_catchup_is_noop(**mi))
+        {
+#ifdef DEBUG_DIAGNOSTICS
+            mons_skipped++;
+#endif
             continue;
+        }
+
+        update_monster(**mi, turns);
     }
 
 #ifdef DEBUG_DIAGNOSTICS
-    dprf("total monsters on level = %d", mons_total);
+    dprf("total monsters on level = %d (%d needed no catch-up)",
+         mons_total, mons_skipped);
 #endif
 
     delete_all_clouds();
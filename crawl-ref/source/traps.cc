@@ -1483,6 +1483,7 @@ void handle_items_on_shaft(const coord_def& pos)
             mitm[o].base_type = OBJ_UNASSIGNED;
             mitm[o].quantity = 0;
             mitm[o].props.clear();
+            item_slot_freed(o);
         }
 
         o = next;
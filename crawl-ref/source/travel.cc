@@ -15,6 +15,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <memory>
+#include <queue>
 #include <set>
 #include <sstream>
 
@@ -1054,21 +1055,25 @@ command_type direction_to_command(int x, int y)
     return CMD_NO_CMD;
 }
 
-static void _fill_exclude_radius(const travel_exclude &exc)
+// Mark the exclusion centres and the known squares they cover that the
+// flood didn't reach.
+static void _fill_excludes()
 {
-    const int radius = exc.radius;
-    const coord_def &c = exc.pos;
-    for (int y = c.y - radius; y <= c.y + radius; ++y)
-        for (int x = c.x - radius; x <= c.x + radius; ++x)
-        {
-            const coord_def p(x, y);
-            if (!map_bounds(x, y) || travel_point_distance[x][y])
-                continue;
+    for (const auto &entry : curr_excludes)
+    {
+        const coord_def &c = entry.second.pos;
+        if (map_bounds(c) && !travel_point_distance[c.x][c.y])
+            travel_point_distance[c.x][c.y] = PD_EXCLUDED;
+    }
 
-            if (is_exclude_root(p))
-                travel_point_distance[x][y] = PD_EXCLUDED;
-            else if (is_excluded(p) && env.map_knowledge(p).known())
-                travel_point_distance[x][y] = PD_EXCLUDED_RADIUS;
+    for (const auto &entry : curr_excludes)
+        for (const coord_def &p : entry.second.points)
+        {
+            if (map_bounds(p) && !travel_point_distance[p.x][p.y]
+                && env.map_knowledge(p).known())
+            {
+                travel_point_distance[p.x][p.y] = PD_EXCLUDED_RADIUS;
+            }
         }
 }
 
@@ -1359,9 +1364,8 @@ coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
             {
                 features->push_back(exc.pos);
             }
-
-            _fill_exclude_radius(exc);
         }
+        _fill_excludes();
     }
 
     return runmode == RMODE_TRAVEL ? travel_move()
@@ -1401,9 +1405,8 @@ void travel_pathfind::get_features()
         // An exclude - wherever it is - is always a feature.
         if (find(features->begin(), features->end(), exc.pos) == features->end())
             features->push_back(exc.pos);
-
-        _fill_exclude_radius(exc);
     }
+    _fill_excludes();
 }
 
 const set<coord_def> travel_pathfind::get_unreachables() const
@@ -2787,6 +2790,33 @@ static int _target_distance_from(const coord_def &pos)
     return -1;
 }
 
+/*
+ * A step of the trans-level travel search: either standing somewhere on a
+ * level we've just entered (or the player's starting square), or standing on
+ * a stair about to take it.
+ */
+struct transtravel_node
+{
+    int distance;
+    level_id level;
+    coord_def pos;          // Where we entered the level; unused for stairs.
+    stair_info *stair;      // The stair about to be taken, or nullptr.
+    coord_def first_stair;  // The first step on the player's level, or
+                            // (-1,-1) for the starting square itself.
+};
+
+struct transtravel_node_compare
+{
+    bool operator() (const transtravel_node &lhs,
+                     const transtravel_node &rhs) const
+    {
+        return lhs.distance > rhs.distance;
+    }
+};
+
+typedef priority_queue<transtravel_node, vector<transtravel_node>,
+                       transtravel_node_compare> transtravel_queue;
+
 /*
  * Sets best_stair to the coordinates of the best stair on the player's current
  * level to take to get to the 'target' level. Should be called with 'distance'
@@ -2797,6 +2827,12 @@ static int _target_distance_from(const coord_def &pos)
  * travel-safe path between the player's current level and the target level OR
  * the player's current level *is* the target level.
  *
+ * This is a shortest-path search over the graph of known stairs: within a
+ * level, the edges are the stair-to-stair distances each LevelInfo keeps up
+ * to date as the player explores, and taking a stair costs a flat 500.
+ * Every stair is expanded at most once per distance improvement, so even
+ * late-game saves with hundreds of known stairs are searched quickly.
+ *
  * This function relies on the travel_point_distance array being correctly
  * populated with a floodout call to find_travel_pos starting from the player's
  * location.
@@ -2812,119 +2848,51 @@ static int _find_transtravel_stair(const level_id &cur,
                                     const coord_def &stair,
                                     level_id &closest_level,
                                     int &best_level_distance,
-                                    coord_def &best_stair,
-                                    int search_depth = 0)
+                                    coord_def &best_stair)
 {
-    int local_distance = -1;
-    level_id player_level = level_id::current();
-
-    LevelInfo &li = travel_cache.get_level_info(cur);
+    const level_id player_level = level_id::current();
+    const coord_def no_stair(-1, -1);
 
-    // Have we reached the target level?
-    if (cur == target.id)
+    int best_distance = -1;
+    coord_def best_first = no_stair;
+    auto found_route = [&](int dist, const coord_def &first)
     {
-        // Are we in an exclude? If so, bail out. Unless it is just a stair exclusion.
-        if (is_excluded(stair, li.get_excludes()) && !is_stair_exclusion(stair))
-            return -1;
-
-        // If there's no target position on the target level, or we're on the
-        // target, we're home.
-        if (target.pos.x == -1 || target.pos == stair)
-            return distance;
-
-        // If there *is* a target position, we need to work out our distance
-        // from it.
-        int deltadist = _target_distance_from(stair);
-
-        if (deltadist == -1 && cur == player_level)
-        {
-            // Okay, we don't seem to have a distance available to us, which
-            // means we're either (a) not standing on stairs or (b) whoever
-            // initiated interlevel travel didn't call
-            // _populate_stair_distances. Assuming we're not on stairs, that
-            // situation can arise only if interlevel travel has been triggered
-            // for a location on the same level. If that's the case, we can get
-            // the distance off the travel_point_distance matrix.
-            deltadist = travel_point_distance[target.pos.x][target.pos.y];
-            if (!deltadist && stair != target.pos)
-                deltadist = -1;
-        }
-
-        if (deltadist != -1)
+        if (best_distance == -1 || dist < best_distance)
         {
-            local_distance = distance + deltadist;
-
-            // See if this is a degenerate case of interlevel travel:
-            // A degenerate case of interlevel travel decays to normal travel;
-            // we identify this by checking if:
-            // a. The current level is the target level.
-            // b. The target square is reachable from the 'current' square.
-            // c. The current square is where the player is.
-            //
-            // Note that even if this *is* degenerate, interlevel travel may
-            // still be able to find a shorter route, since it can consider
-            // routes that leave and reenter the current level.
-            if (player_level == target.id && stair == you.pos())
-                best_stair = target.pos;
-
-            // The local_distance is already set, but there may actually be
-            // stairs we can take that'll get us to the target faster than the
-            // direct route, so we also try the stairs.
+            best_distance = dist;
+            best_first = first;
         }
-    }
-
-    vector<stair_info> &stairs = li.get_stairs();
-
-    // this_stair being nullptr is perfectly acceptable, since we start with
-    // coords as the player coords, and the player need not be standing on
-    // stairs.
-    stair_info *this_stair = li.get_stair(stair);
+    };
 
-    if (!this_stair && cur != player_level)
-    {
-        // Whoops, there's no stair in the travel cache for the current
-        // position, and we're not on the player's current level (i.e., there
-        // certainly *should* be a stair here). Since we can't proceed in any
-        // reasonable way, bail out.
-        return local_distance;
-    }
+    transtravel_queue queue;
+    queue.push({ distance, cur, stair, nullptr, no_stair });
 
-    for (stair_info &si : stairs)
+    while (!queue.empty())
     {
-        if (stairs_destination_is_excluded(si))
-            continue;
+        const transtravel_node node = queue.top();
+        queue.pop();
 
-        // Skip placeholders and excluded stairs.
-        if (!si.can_travel() || is_excluded(si.position, li.get_excludes()))
-            continue;
+        // Nothing we could still find can beat the best route so far.
+        if (best_distance != -1 && node.distance >= best_distance)
+            break;
 
-        int deltadist = li.distance_between(this_stair, &si);
+        LevelInfo &li = travel_cache.get_level_info(node.level);
+        const bool start = node.first_stair == no_stair && !node.stair;
 
-        if (!this_stair)
+        if (node.stair)
         {
-            deltadist = travel_point_distance[si.position.x][si.position.y];
-            if (!deltadist && you.pos() != si.position)
-                deltadist = -1;
-        }
-        // deltadist == 0 is legal (if this_stair is nullptr), since the player
-        // may be standing on the stairs. If two stairs are disconnected,
-        // deltadist has to be negative.
-        if (deltadist < 0)
-            continue;
-
-        int dist2stair = distance + deltadist;
-        if (si.distance == -1 || si.distance > dist2stair)
-        {
-            si.distance = dist2stair;
+            stair_info &si = *node.stair;
+            // Stale: we've since found a shorter way to this stair.
+            if (si.distance < node.distance)
+                continue;
 
             // Account for the cost of taking the stairs
-            dist2stair += 500; // XXX: this seems large?
-
-            // Already too expensive? Short-circuit.
-            if (local_distance != -1 && dist2stair >= local_distance)
+            const int dist2stair = node.distance + 500; // XXX: this seems large?
+            if (best_distance != -1 && dist2stair >= best_distance)
                 continue;
 
             const level_pos &dest = si.destination;
+            const coord_def first = node.first_stair;
 
             // Never use escape hatches as the last leg of the trip, since
             // that will leave the player unable to retrace their path.
@@ -2941,15 +2909,9 @@ static int _find_transtravel_stair(const level_id &cur,
             // have no exact target location. If there *is* an exact target
             // location, we can't follow stairs for which we have incomplete
             // information.
-            if (target.pos.x == -1
-                && dest.id == target.id)
+            if (target.pos.x == -1 && dest.id == target.id)
             {
-                if (local_distance == -1 || local_distance > dist2stair)
-                {
-                    local_distance = dist2stair;
-                    if (cur == player_level && you.pos() == stair)
-                        best_stair = si.position;
-                }
+                found_route(dist2stair, first);
                 continue;
             }
 
@@ -2978,7 +2940,7 @@ static int _find_transtravel_stair(const level_id &cur,
             // used while exiting from the vestibule.
             if (is_hell_branch(dest.id.branch)
                             && !(is_hell_branch(target.id.branch)
-                                 || is_hell_branch(cur.branch)))
+                                 || is_hell_branch(node.level.branch)))
             {
                 continue;
             }
@@ -2994,28 +2956,119 @@ static int _find_transtravel_stair(const level_id &cur,
                     continue;   // We've already been here.
             }
 #ifdef DEBUG_TRAVEL
-            string indent(search_depth, '.');
-            dprf("%strying stairs at %d,%d, dest is %d depth %d, pos %d,%d",
-                indent.c_str(), si.position.x, si.position.y, dest.id.branch,
-                dest.id.depth, dest.pos.x, dest.pos.y);
+            dprf("trying stairs at %d,%d, dest is %d depth %d, pos %d,%d",
+                 si.position.x, si.position.y, dest.id.branch,
+                 dest.id.depth, dest.pos.x, dest.pos.y);
 #endif
 
             // Okay, take these stairs and keep going.
-            const int newdist =
-                _find_transtravel_stair(dest.id, target,
-                                        dist2stair, dest.pos, closest_level,
-                                        best_level_distance, best_stair,
-                                        search_depth + 1);
-            if (newdist != -1
-                && (local_distance == -1 || local_distance > newdist))
+            queue.push({ dist2stair, dest.id, dest.pos, nullptr, first });
+            continue;
+        }
+
+        // We're standing somewhere on node.level, having just arrived.
+        stair_info *this_stair = li.get_stair(node.pos);
+        if (!start && this_stair && this_stair->distance < node.distance)
+            continue;
+
+        // Have we reached the target level?
+        if (node.level == target.id)
+        {
+            // Are we in an exclude? If so, bail out. Unless it is just a stair
+            // exclusion.
+            if (is_excluded(node.pos, li.get_excludes())
+                && !is_stair_exclusion(node.pos))
+            {
+                continue;
+            }
+
+            // If there's no target position on the target level, or we're on
+            // the target, we're home.
+            if (target.pos.x == -1 || target.pos == node.pos)
+            {
+                found_route(node.distance, node.first_stair);
+                continue;
+            }
+
+            // If there *is* a target position, we need to work out our
+            // distance from it.
+            int deltadist = _target_distance_from(node.pos);
+
+            if (deltadist == -1 && node.level == player_level)
+            {
+                // Okay, we don't seem to have a distance available to us,
+                // which means we're either (a) not standing on stairs or (b)
+                // whoever initiated interlevel travel didn't call
+                // _populate_stair_distances. Assuming we're not on stairs,
+                // that situation can arise only if interlevel travel has been
+                // triggered for a location on the same level. If that's the
+                // case, we can get the distance off the travel_point_distance
+                // matrix.
+                deltadist = travel_point_distance[target.pos.x][target.pos.y];
+                if (!deltadist && node.pos != target.pos)
+                    deltadist = -1;
+            }
+
+            // A degenerate case of interlevel travel decays to normal travel,
+            // when the target square is reachable from where the player is.
+            // Even then, there may be stairs we can take that'll get us to
+            // the target faster than the direct route, so we also try those.
+            if (deltadist != -1)
+            {
+                found_route(node.distance + deltadist,
+                            node.level == player_level && node.pos == you.pos()
+                            ? target.pos : node.first_stair);
+            }
+        }
+
+        // this_stair being nullptr is perfectly acceptable, since we start
+        // with coords as the player coords, and the player need not be
+        // standing on stairs.
+        if (!this_stair && node.level != player_level)
+        {
+            // Whoops, there's no stair in the travel cache for the current
+            // position, and we're not on the player's current level (i.e.,
+            // there certainly *should* be a stair here). Since we can't
+            // proceed in any reasonable way, stop here.
+            continue;
+        }
+
+        for (stair_info &si : li.get_stairs())
+        {
+            if (stairs_destination_is_excluded(si))
+                continue;
+
+            // Skip placeholders and excluded stairs.
+            if (!si.can_travel() || is_excluded(si.position, li.get_excludes()))
+                continue;
+
+            int deltadist = li.distance_between(this_stair, &si);
+
+            if (!this_stair)
+            {
+                deltadist = travel_point_distance[si.position.x][si.position.y];
+                if (!deltadist && you.pos() != si.position)
+                    deltadist = -1;
+            }
+            // deltadist == 0 is legal (if this_stair is nullptr), since the
+            // player may be standing on the stairs. If two stairs are
+            // disconnected, deltadist has to be negative.
+            if (deltadist < 0)
+                continue;
+
+            const int dist2stair = node.distance + deltadist;
+            if (si.distance == -1 || si.distance > dist2stair)
             {
-                local_distance = newdist;
-                if (cur == player_level && you.pos() == stair)
-                    best_stair = si.position;
+                si.distance = dist2stair;
+                queue.push({ dist2stair, node.level, si.position, &si,
+                             start ? si.position : node.first_stair });
             }
         }
     }
-    return local_distance;
+
+    if (best_first != no_stair)
+        best_stair = best_first;
+    return best_distance;
 }
 
 static bool _loadlev_populate_stair_distances(const level_pos &target)
@@ -3439,7 +3492,9 @@ void LevelInfo::set_distance_between_stairs(int a, int b, int dist)
     stair_distances[b * stairs.size() + a] = dist;
 }
 
-void LevelInfo::update_stair_distances()
+// The reference version of update_stair_distances(): a separate flood from
+// each stair. Kept for check_stair_distances().
+void LevelInfo::update_stair_distances_per_stair()
 {
     const int nstairs = stairs.size();
     // Now we update distances for all the stairs, relative to all other
@@ -3465,6 +3520,162 @@ void LevelInfo::update_stair_distances()
         set_distance_between_stairs(nstairs - 1, nstairs - 1, 0);
 }
 
+// Which of the (up to 64) stairs in the current batch have reached a square.
+typedef uint64_t stair_set;
+
+// Flood out from up to 64 stairs at once, each bit of a square's stair_set
+// standing for one of them, and call found(stairs, square, dist) whenever
+// some of them first reach a square.
+//
+// This has to give exactly the distances the single-stair floods in
+// travel_pathfind::pathfind() do: a square first reached in round n has
+// distance n, and is expanded in round n + _feature_traverse_cost(). The
+// stairs themselves count as reached in round 0. Since no square costs
+// more than 3, four rounds' worth of pending squares are enough.
+template <typename F>
+static void _flood_from_stairs(const vector<coord_def> &sources, F found)
+{
+    const int nrounds = 4;
+    typedef FixedArray<stair_set, GXM, GYM> stair_set_grid;
+    // Too big for the stack.
+    auto reached_grid = make_unique<stair_set_grid>();
+    stair_set_grid &reached(*reached_grid);
+    vector<stair_set_grid> pending(nrounds);
+    vector<coord_def> agenda[nrounds];
+    int queued = 0;
+
+    reached.init(0);
+    for (auto &round : pending)
+        round.init(0);
+
+    LevelInfo &li = travel_cache.get_level_info(level_id::current());
+
+    auto schedule = [&](const coord_def &c, int round, stair_set stairs)
+    {
+        stair_set &p = pending[round % nrounds](c);
+        if (!p)
+        {
+            agenda[round % nrounds].push_back(c);
+            ++queued;
+        }
+        p |= stairs;
+    };
+
+    for (int i = 0, size = sources.size(); i < size; ++i)
+    {
+        const coord_def &c = sources[i];
+        // Placeholder stairs go nowhere.
+        if (!in_bounds(c))
+            continue;
+
+        reached(c) |= stair_set(1) << i;
+        schedule(c, _feature_traverse_cost(env.map_knowledge(c).feat()),
+                 stair_set(1) << i);
+    }
+
+    auto flood = [&](const coord_def &c, const coord_def &dc, int round,
+                     stair_set stairs)
+    {
+        if (!in_bounds(dc)
+            // An excluded transporter isn't taken, as in path_flood().
+            || is_excluded(c)
+               && env.map_knowledge(c).feat() == DNGN_TRANSPORTER
+               && !adjacent(c, dc)
+            || !_is_travelsafe_square(dc, false, false, true))
+        {
+            return;
+        }
+
+        const stair_set fresh = stairs & ~reached(dc);
+        if (!fresh)
+            return;
+
+        reached(dc) |= fresh;
+        found(fresh, dc, round);
+        schedule(dc,
+                 round + _feature_traverse_cost(env.map_knowledge(dc).feat()),
+                 fresh);
+    };
+
+    for (int round = 1; queued; ++round)
+    {
+        // flood() only ever schedules later rounds, so this agenda doesn't
+        // grow under us.
+        vector<coord_def> &now = agenda[round % nrounds];
+        for (const coord_def &c : now)
+        {
+            stair_set &p = pending[round % nrounds](c);
+            const stair_set stairs = p;
+            p = 0;
+
+            for (int dir = 0; dir < 8; ++dir)
+                flood(c, c + Compass[dir], round, stairs);
+
+            if (grd(c) == DNGN_TRANSPORTER)
+            {
+                transporter_info *ti = li.get_transporter(c);
+                if (ti && ti->destination != INVALID_COORD)
+                    flood(c, ti->destination, round, stairs);
+            }
+        }
+        queued -= now.size();
+        now.clear();
+    }
+}
+
+void LevelInfo::update_stair_distances()
+{
+    const int nstairs = stairs.size();
+    // Stairs that can't reach each other stay at -1.
+    for (int s = 0; s < nstairs; ++s)
+        for (int other = s; other < nstairs; ++other)
+            set_distance_between_stairs(s, other, s == other ? 0 : -1);
+
+    // No two stairs share a square.
+    FixedArray<int, GXM, GYM> stair_at;
+    stair_at.init(-1);
+    for (int s = 0; s < nstairs; ++s)
+        if (in_bounds(stairs[s].position))
+            stair_at(stairs[s].position) = s;
+
+    // Distances aren't quite symmetric (a closed door costs more to leave
+    // than to enter), so as before, the distance between two stairs is the
+    // one measured from whichever comes first in the list, and the last
+    // stair needn't flood at all.
+    const int batch = sizeof(stair_set) * CHAR_BIT;
+    for (int first = 0; first < nstairs - 1; first += batch)
+    {
+        vector<coord_def> sources;
+        for (int s = first; s < min(first + batch, nstairs - 1); ++s)
+            sources.push_back(stairs[s].position);
+
+        _flood_from_stairs(sources,
+            [&](stair_set reached, const coord_def &c, int dist)
+            {
+                const int other = stair_at(c);
+                if (other == -1)
+                    return;
+
+                for (int s = first; s < other && reached; ++s, reached >>= 1)
+                    if (reached & 1)
+                        set_distance_between_stairs(s, other, dist);
+            });
+    }
+}
+
+bool LevelInfo::check_stair_distances()
+{
+    update();
+    const vector<short> distances = stair_distances;
+
+    unwind_slime_wall_precomputer slime_wall_neighbours(
+        !actor_slime_wall_immune(&you));
+    precompute_travel_safety_grid travel_safety_calc;
+    update_stair_distances_per_stair();
+
+    return stair_distances == distances;
+}
+
 void LevelInfo::update_transporter(const coord_def& transpos,
                                    const coord_def& dest)
 {
@@ -373,6 +373,10 @@ struct LevelInfo
     // current level.
     bool is_known_branch(uint8_t branch) const;
 
+    // Updates the level, then checks the stair distances against those found
+    // by flooding from one stair at a time.
+    bool check_stair_distances();
+
     FixedVector<int, NUM_DACTION_COUNTERS> daction_counters;
 
 private:
@@ -384,6 +388,7 @@ private:
     void correct_stair_list(const vector<coord_def> &s);
     void correct_transporter_list(const vector<coord_def> &s);
     void update_stair_distances();
+    void update_stair_distances_per_stair();
     void sync_all_branch_stairs();
     void sync_branch_stairs(const stair_info *si);
     void set_distance_between_stairs(int a, int b, int dist);
@@ -8,6 +8,7 @@
 #include <numeric>
 #include <stack>
 #include <chrono>
+#include <cwctype>
 
 #include "ui.h"
 #include "cio.h"
@@ -242,6 +243,8 @@ void Widget::render()
         _render();
 }
 
+constexpr int Widget::num_cached_heights;
+
 SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
 {
     ASSERT((dim == HORZ) == (prosp_width == -1));
@@ -249,9 +252,18 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
     if (!m_visible)
         return { 0, 0 };
 
-    if (cached_sr_valid[dim] && (!dim || cached_sr_pw == prosp_width))
-        return cached_sr[dim];
+    if (cached_sr_valid[dim])
+    {
+        if (!dim)
+            return cached_sr_horz;
+        for (int i = 0; i < cached_sr_vert_count; ++i)
+            if (cached_sr_vert[i].prosp_width == prosp_width)
+                return cached_sr_vert[i].sr;
+    }
 
+    // The cache is keyed by the width we were asked about, not the one left
+    // after margins.
+    const int asked_width = prosp_width;
     prosp_width = dim ? prosp_width - margin.right - margin.left : prosp_width;
     SizeReq ret = _get_preferred_size(dim, prosp_width);
     ASSERT(ret.min <= ret.nat);
@@ -282,10 +294,18 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
 
     ret.nat = min(ret.nat, ui_expand_sz);
 
+    if (!dim)
+        cached_sr_horz = ret;
+    else
+    {
+        if (!cached_sr_valid[dim])
+            cached_sr_vert_count = cached_sr_vert_next = 0;
+        cached_sr_vert[cached_sr_vert_next] = { asked_width, ret };
+        cached_sr_vert_next = (cached_sr_vert_next + 1) % num_cached_heights;
+        cached_sr_vert_count = min(cached_sr_vert_count + 1,
+                                   num_cached_heights);
+    }
     cached_sr_valid[dim] = true;
-    cached_sr[dim] = ret;
-    if (dim)
-        cached_sr_pw = prosp_width;
 
     return ret;
 }
@@ -604,15 +624,33 @@ void Text::set_text(const formatted_string &fs)
     m_text += fs;
     _invalidate_sizereq();
     _expose();
-    m_wrapped_size = Size(-1);
+    _invalidate_wrap();
     _queue_allocation();
 }
 
+void Text::_invalidate_wrap()
+{
+    m_wrapped_size = Size(-1);
+    m_wrap_cache.clear();
+}
+
+void Text::_swap_wrap(wrap_result &other)
+{
+    swap(m_wrapped_size, other.size);
+#ifdef USE_TILE_LOCAL
+    m_text_wrapped.ops.swap(other.text_wrapped.ops);
+    m_brkpts.swap(other.brkpts);
+#else
+    m_wrapped_lines.swap(other.wrapped_lines);
+#endif
+}
+
 #ifdef USE_TILE_LOCAL
 void Text::set_font(FontWrapper *font)
 {
     ASSERT(font);
     m_font = font;
+    _invalidate_wrap();
     _queue_allocation();
 }
 #endif
@@ -629,6 +667,22 @@ void Text::wrap_text_to_size(int width, int height)
     Size wrapped_size = { width, height };
     if (m_wrapped_size == wrapped_size)
         return;
+
+    for (wrap_result &cached : m_wrap_cache)
+        if (cached.size == wrapped_size)
+        {
+            _swap_wrap(cached);
+            return;
+        }
+
+    // Keep the current wrap for later, dropping the oldest if need be.
+    if (!(m_wrapped_size == Size(-1)))
+    {
+        if (m_wrap_cache.size() >= wrap_cache_size)
+            m_wrap_cache.erase(m_wrap_cache.begin());
+        m_wrap_cache.emplace_back();
+        _swap_wrap(m_wrap_cache.back());
+    }
     m_wrapped_size = wrapped_size;
 
     height = height ? height : 0xfffffff;
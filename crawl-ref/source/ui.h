@@ -464,9 +464,21 @@ protected:
 #endif
 
 private:
+    // Parents often ask for a child's height at more than one width in the
+    // same layout pass (a first guess, then the width they actually give),
+    // so a few recent heights are kept rather than just the last one.
+    static constexpr int num_cached_heights = 3;
+    struct cached_height
+    {
+        int prosp_width;
+        SizeReq sr;
+    };
+
     bool cached_sr_valid[2] = { false, false };
-    SizeReq cached_sr[2];
-    int cached_sr_pw;
+    SizeReq cached_sr_horz;
+    cached_height cached_sr_vert[num_cached_heights];
+    int cached_sr_vert_count = 0;
+    int cached_sr_vert_next = 0;
     bool alloc_queued = false;
     bool m_visible = true;
     Widget* m_parent = nullptr;
@@ -709,6 +721,7 @@ public:
         if (wrap_text == _wrap_text)
             return;
         wrap_text = _wrap_text;
+        _invalidate_wrap();
         _invalidate_sizereq();
     }
 
@@ -717,11 +730,13 @@ public:
         if (ellipsize == _ellipsize)
             return;
         ellipsize = _ellipsize;
+        _invalidate_wrap();
         _invalidate_sizereq();
     }
 
 protected:
     void wrap_text_to_size(int width, int height);
+    void _invalidate_wrap();
 
     bool wrap_text = false;
     bool ellipsize = false;
@@ -738,6 +753,24 @@ protected:
     COLOURS m_bg_colour = BLACK;
 #endif
     Size m_wrapped_size = Size{-1};
+
+    // Earlier wraps of the same text, oldest first. Sizing wraps with no
+    // height limit and allocation wraps to the allocated height, so without
+    // these every layout pass would wrap the text twice over.
+    struct wrap_result
+    {
+        Size size;
+#ifdef USE_TILE_LOCAL
+        formatted_string text_wrapped;
+        vector<brkpt> brkpts;
+#else
+        vector<formatted_string> wrapped_lines;
+#endif
+    };
+    static constexpr size_t wrap_cache_size = 2;
+    vector<wrap_result> m_wrap_cache;
+    void _swap_wrap(wrap_result &other);
+
     string hl_pat;
     bool hl_line;
 };
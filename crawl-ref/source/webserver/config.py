@@ -49,6 +49,11 @@ template_path = "./webserver/templates/"
 # Path for server-side unix sockets (to be used to communicate with crawl)
 server_socket_path = None # Uses global temp dir
 
+# Ask crawl to send game output through a shared-memory ring instead of its
+# socket, which saves fragmenting every frame into datagrams. Crawl versions
+# that don't support it keep using the socket.
+shm_transport = False
+
 # Server name, so far only used in the ttyrec metadata
 server_id = ""
 
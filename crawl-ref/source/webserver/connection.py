@@ -5,9 +5,11 @@ import time
 import warnings
 
 from datetime import datetime, timedelta
-from tornado.escape import json_encode
+from tornado.escape import json_encode, json_decode
 
+import config
 from config import server_socket_path
+from shm_ring import RingReader
 
 class WebtilesSocketConnection(object):
     def __init__(self, io_loop, socketpath, logger):
@@ -19,6 +21,7 @@ class WebtilesSocketConnection(object):
         self.socketpath = None
         self.open = False
         self.close_callback = None
+        self.ring = None
 
         self.msg_buffer = None
 
@@ -59,10 +62,15 @@ class WebtilesSocketConnection(object):
                                  self._handle_read,
                                  self.io_loop.ERROR | self.io_loop.READ)
 
-        msg = json_encode({
-                "msg": "attach",
-                "primary": primary
-                })
+        attach = {
+            "msg": "attach",
+            "primary": primary,
+            # Crawl may send everything between two input waits at once.
+            "batch": True
+            }
+        if getattr(config, "shm_transport", False):
+            attach["transport"] = "shm"
+        msg = json_encode(attach)
 
         self.open = True
 
@@ -88,9 +96,39 @@ class WebtilesSocketConnection(object):
 
         else:
             self.msg_buffer = None
-
-            if self.message_callback:
-                self.message_callback(data)
+            self._dispatch(data)
+
+    def _dispatch(self, data):
+        # Messages never contain a raw newline, so a batch splits cleanly.
+        for msg in data[:-1].split("\n"):
+            msg += "\n"
+            if msg.startswith('*{"msg":"shm_transport"'):
+                self._attach_ring(json_decode(msg[1:]))
+            elif self.message_callback:
+                self.message_callback(msg)
+
+    def _attach_ring(self, offer):
+        # Crawl sends everything after the offer through the ring, so if we
+        # can't read it, the game is lost to us.
+        try:
+            self.ring = RingReader(offer["ring"], offer["bell"])
+        except (OSError, IOError, ValueError):
+            self.logger.warning("Can't attach to the game's message ring",
+                                exc_info=True)
+            self.close()
+            return
+        self.io_loop.add_handler(self.ring.bell_fd, self._handle_bell,
+                                 self.io_loop.READ)
+        # Anything crawl wrote before we got here won't ring again.
+        self._handle_bell(self.ring.bell_fd, self.io_loop.READ)
+
+    def _handle_bell(self, fd, events):
+        self.ring.drain_bell()
+        for data, sent in self.ring.read():
+            self._dispatch(data)
+            if not self.ring:
+                # The callback closed the connection.
+                break
 
     def send_message(self, data):
         start = datetime.now()
@@ -105,6 +143,10 @@ class WebtilesSocketConnection(object):
             self.logger.warning("Slow socket send: " + str(end - start))
 
     def close(self):
+        if self.ring:
+            self.io_loop.remove_handler(self.ring.bell_fd)
+            self.ring.close()
+            self.ring = None
         if self.socket:
             self.io_loop.remove_handler(self.socket.fileno())
             self.socket.close()
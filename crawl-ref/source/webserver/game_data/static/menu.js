@@ -117,7 +117,7 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
         menu.items = { length: menu.total_items };
         menu.first_present = 999999;
         menu.last_present = -999999;
-        update_item_range(menu.chunk_start, chunk);
+        update_item_range(menu.chunk_start, chunk, true);
 
         menu.scroller = scroller(content_div[0]);
         menu.scroller.scrollElement.addEventListener('scroll', menu_scroll_handler);
@@ -184,7 +184,8 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
             var item = {
                 level: 2,
                 text: "...",
-                index: i
+                index: i,
+                missing: true
             };
             var elem = $("<li>...</li>");
             elem.data("item", item);
@@ -205,7 +206,7 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
             menu.last_present = end;
     }
 
-    function update_item_range(chunk_start, items_list)
+    function update_item_range(chunk_start, items_list, complete)
     {
         prepare_item_range(0, menu.total_items-1);
         for (var i = 0; i < items_list.length; ++i)
@@ -221,6 +222,10 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
                     text: new_item
                 };
             }
+            // An update to an item we haven't been sent yet only has some
+            // of its fields, so we still need the rest.
+            if (complete)
+                delete item.missing;
             $.extend(item, new_item);
             if (new_item.colour === undefined)
                 delete item.colour;
@@ -455,10 +460,41 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
 
     function update_menu_items(data)
     {
-        update_item_range(data.chunk_start, data.items);
+        update_item_range(data.chunk_start, data.items, data.complete);
         handle_size_change();
     }
 
+    // The server only sends the items around where the menu opens; ask for
+    // any others in or near view. Spectators only get what the player has
+    // asked for.
+    var request_margin = 50;
+    function request_missing_items()
+    {
+        if (!menu || menu.type === "crt" || client.is_watching())
+            return;
+
+        var start = Math.max(menu.first_visible - request_margin, 0);
+        // last_visible isn't set if the bottom of the menu is in view.
+        var end = menu.last_visible < menu.first_visible
+                  ? menu.total_items - 1
+                  : Math.min(menu.last_visible + request_margin,
+                             menu.total_items - 1);
+
+        var wanted = function (item) {
+            return item.missing && !item.requested;
+        };
+        while (start <= end && !wanted(menu.items[start]))
+            start++;
+        while (start <= end && !wanted(menu.items[end]))
+            end--;
+        if (start > end)
+            return;
+
+        for (var i = start; i <= end; ++i)
+            menu.items[i].requested = true;
+        comm.send_message("*request_menu_range", { start: start, end: end });
+    }
+
     function server_menu_scroll(data)
     {
         if (!client.is_watching())
@@ -505,6 +541,7 @@ function ($, comm, client, ui, enums, cr, util, options, scroller) {
             menu.following_player_scroll = false;
 
         update_visible_indices();
+        request_missing_items();
         schedule_server_scroll();
     }
 
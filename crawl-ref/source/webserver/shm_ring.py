@@ -0,0 +1,210 @@
+"""Reading end of crawl's shared-memory message ring.
+
+When the server attaches with "transport": "shm", crawl creates a ring file
+and a doorbell fifo next to its socket, offers them over the socket, and
+from then on writes its messages into the ring (see tileweb-ring.h for the
+layout). The doorbell becomes readable whenever there is something new.
+
+Run as a script, this is a stand-alone consumer for measuring the transport
+against a crawl started with -webtiles-socket and -await-connection: it
+attaches, keeps asking crawl to resend its whole state, and reports
+messages per second and latency. Pass --socket to measure the plain socket
+transport the same way.
+
+  python shm_ring.py [--socket] [--seconds N] <crawl socket>
+"""
+
+from __future__ import print_function
+
+import errno
+import mmap
+import os
+import struct
+
+MAGIC = b"CRAWLRB1"
+HEADER = struct.Struct("<8sIIQQ")
+RECORD = struct.Struct("<IQ")
+STATE_OFFSET = 12
+TAIL_OFFSET = 24
+DATA_OFFSET = 64
+
+READER_ATTACHED = 1
+READER_GONE = 2
+
+class RingReader(object):
+    def __init__(self, ring_path, bell_path):
+        self.bell_fd = os.open(bell_path, os.O_RDONLY | os.O_NONBLOCK)
+        try:
+            fd = os.open(ring_path, os.O_RDWR)
+            try:
+                self.map = mmap.mmap(fd, 0)
+            finally:
+                os.close(fd)
+        except:
+            os.close(self.bell_fd)
+            raise
+
+        magic, self.capacity, _, _, self.tail = HEADER.unpack_from(self.map, 0)
+        if magic != MAGIC:
+            self.close()
+            raise ValueError("Not a crawl message ring: " + ring_path)
+        self.head = self.tail
+        self.bell = b""
+        self.pending = bytearray()
+        struct.pack_into("<I", self.map, STATE_OFFSET, READER_ATTACHED)
+
+    def drain_bell(self):
+        """Pick up the latest head crawl has rung the doorbell with."""
+        try:
+            while True:
+                data = os.read(self.bell_fd, 4096)
+                if not data:
+                    break
+                self.bell += data
+        except OSError as e:
+            if e.errno not in (errno.EAGAIN, errno.EWOULDBLOCK):
+                raise
+        whole = len(self.bell) - len(self.bell) % 8
+        if whole:
+            self.head, = struct.unpack_from("<Q", self.bell, whole - 8)
+            self.bell = self.bell[whole:]
+
+    def read(self):
+        """Return (message, send time) for every complete message in the
+        ring. A message crawl is still writing stays pending until the rest
+        of it arrives."""
+        # Only trust the head that came through the doorbell, not the one
+        # in the header: crawl writes it to the pipe after the bytes before
+        # it, and the pipe makes those visible to us on any architecture.
+        head = self.head
+        if head != self.tail:
+            start = self.tail % self.capacity
+            end = start + (head - self.tail)
+            if end <= self.capacity:
+                self.pending += self.map[DATA_OFFSET + start:DATA_OFFSET + end]
+            else:
+                self.pending += self.map[DATA_OFFSET + start:
+                                         DATA_OFFSET + self.capacity]
+                self.pending += self.map[DATA_OFFSET:
+                                         DATA_OFFSET + end - self.capacity]
+            self.tail = head
+            struct.pack_into("<Q", self.map, TAIL_OFFSET, head)
+
+        messages = []
+        pos = 0
+        while len(self.pending) - pos >= RECORD.size:
+            length, sent = RECORD.unpack_from(self.pending, pos)
+            end = pos + RECORD.size + length
+            if end > len(self.pending):
+                break
+            messages.append((bytes(self.pending[pos + RECORD.size:end]),
+                             sent / 1000000.0))
+            pos = end
+        del self.pending[:pos]
+        return messages
+
+    def close(self):
+        if self.map:
+            struct.pack_into("<I", self.map, STATE_OFFSET, READER_GONE)
+            self.map.close()
+            self.map = None
+        if self.bell_fd is not None:
+            os.close(self.bell_fd)
+            self.bell_fd = None
+
+
+def _benchmark(crawl_socket, use_ring, seconds):
+    import json
+    import select
+    import socket
+    import tempfile
+    import time
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 212992)
+    sockdir = tempfile.mkdtemp()
+    sockpath = os.path.join(sockdir, "consumer")
+    sock.bind(sockpath)
+
+    def send(**msg):
+        sock.sendto(json.dumps(msg).encode(), crawl_socket)
+
+    ring = None
+    latencies = []
+    count = [0, 0]  # messages, bytes
+    partial = [b""]
+
+    def got(data, sent=None):
+        count[0] += data.count(b"\n")
+        count[1] += len(data)
+        if sent is not None:
+            latencies.append(time.time() - sent)
+
+    def read_socket():
+        data = partial[0] + sock.recv(128 * 1024)
+        if not data.endswith(b"\n"):
+            partial[0] = data
+            return None
+        partial[0] = b""
+        offer = None
+        for msg in data[:-1].split(b"\n"):
+            msg += b"\n"
+            if msg.startswith(b'*{"msg":"shm_transport"'):
+                offer = json.loads(msg[1:].decode())
+            else:
+                got(msg)
+        return offer
+
+    try:
+        if use_ring:
+            send(msg="attach", primary=False, batch=True, transport="shm")
+        else:
+            send(msg="attach", primary=False, batch=True)
+        start = time.time()
+        last_resend = 0
+        while time.time() < start + seconds:
+            now = time.time()
+            if now - last_resend > 0.01:
+                send(msg="spectator_joined")
+                last_resend = now
+            fds = [sock] + ([ring.bell_fd] if ring else [])
+            readable, _, _ = select.select(fds, [], [], 0.01)
+            if sock in readable:
+                offer = read_socket()
+                if offer:
+                    ring = RingReader(offer["ring"], offer["bell"])
+            if ring:
+                ring.drain_bell()
+                for data, sent in ring.read():
+                    got(data, sent)
+        elapsed = time.time() - start
+    finally:
+        if ring:
+            ring.close()
+        sock.close()
+        os.remove(sockpath)
+        os.rmdir(sockdir)
+
+    print("%s: %d messages, %.1f MB in %.1f s: %.0f messages/s, %.1f MB/s"
+          % ("ring" if ring else "socket", count[0], count[1] / 1e6, elapsed,
+             count[0] / elapsed, count[1] / 1e6 / elapsed))
+    if latencies:
+        latencies.sort()
+        def pct(p):
+            return latencies[min(len(latencies) - 1,
+                                 int(len(latencies) * p))] * 1000
+        print("latency (ms): median %.3f, p99 %.3f, max %.3f"
+              % (pct(0.5), pct(0.99), latencies[-1] * 1000))
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(
+        description="Measure crawl's webtiles message transport.")
+    parser.add_argument("crawl_socket")
+    parser.add_argument("--socket", action="store_true",
+                        help="use the plain socket instead of the ring")
+    parser.add_argument("--seconds", type=float, default=10)
+    args = parser.parse_args()
+    _benchmark(args.crawl_socket, not args.socket, args.seconds)
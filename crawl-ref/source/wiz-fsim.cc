@@ -8,12 +8,18 @@
 #include "wiz-fsim.h"
 
 #include <cerrno>
+#ifndef TARGET_OS_WINDOWS
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
 
 #include "beam.h"
 #include "bitary.h"
 #include "coordit.h"
 #include "dbg-util.h"
 #include "directn.h"
+#include "dungeon.h"
+#include "end.h"
 #include "env.h"
 #include "fight.h"
 #include "item-prop.h"
@@ -21,6 +27,7 @@
 #include "item-use.h"
 #include "jobs.h"
 #include "libutil.h"
+#include "los.h"
 #include "makeitem.h"
 #include "message.h"
 #include "mgen-data.h"
@@ -29,6 +36,9 @@
 #include "mon-place.h"
 #include "monster.h"
 #include "mon-util.h"
+#include "newgame-def.h"
+#include "ng-init.h"
+#include "ng-setup.h"
 #include "options.h"
 #include "output.h"
 #include "player-equip.h"
@@ -38,6 +48,7 @@
 #include "species.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "throw.h"
 #include "unwind.h"
 #include "version.h"
@@ -251,11 +262,51 @@ static bool _fsim_kit_equip(const string &kit, string &error)
         }
     }
 
-    redraw_screen();
     return true;
 }
 
 // fight simulator internals
+static monster *_create_fsim_monster(monster_type mtype)
+{
+    mgen_data temp = mgen_data::hostile_at(mtype, false, you.pos());
+    temp.flags |= MG_DONT_COME;
+    temp.extra_flags |= MF_HARD_RESET | MF_NO_REWARD;
+    monster *mon = create_monster(temp);
+    if (!mon)
+        mpr("Failed to create monster.");
+    return mon;
+}
+
+static bool _ready_fsim_monster(monster &mon, int &force_distance)
+{
+    force_distance = grid_distance(you.pos(), mon.pos());
+
+    // move the monster next to the player
+    // this probably works best in the arena, or at least somewhere
+    // where there's no water or anything weird to interfere
+    if (!adjacent(mon.pos(), you.pos()))
+    {
+        for (adjacent_iterator ai(you.pos()); ai; ++ai)
+            if (mon.move_to_pos(*ai))
+                break;
+    }
+
+    if (!adjacent(mon.pos(), you.pos()))
+    {
+        monster_die(mon, KILL_DISMISSED, NON_MONSTER);
+        mpr("Could not put monster adjacent to player.");
+        return false;
+    }
+
+    // prevent distracted stabbing
+    mon.foe = MHITYOU;
+    // this line is actually kind of important for distortion now
+    mon.hit_points = mon.max_hit_points = MAX_MONSTER_HP;
+    mon.behaviour = BEH_SEEK;
+
+    return true;
+}
+
 static monster* _init_fsim(int & force_distance)
 {
     monster * mon = nullptr;
@@ -296,41 +347,13 @@ static monster* _init_fsim(int & force_distance)
                 you.unique_creatures.set(mtype, false);
         }
 
-        mgen_data temp = mgen_data::hostile_at(mtype, false, you.pos());
-        temp.flags |= MG_DONT_COME;
-        temp.extra_flags |= MF_HARD_RESET | MF_NO_REWARD;
-        mon = create_monster(temp);
+        mon = _create_fsim_monster(mtype);
         if (!mon)
-        {
-            mpr("Failed to create monster.");
             return nullptr;
-        }
-    }
-
-    force_distance = grid_distance(you.pos(), mon->pos());
-
-    // move the monster next to the player
-    // this probably works best in the arena, or at least somewhere
-    // where there's no water or anything weird to interfere
-    if (!adjacent(mon->pos(), you.pos()))
-    {
-        for (adjacent_iterator ai(you.pos()); ai; ++ai)
-            if (mon->move_to_pos(*ai))
-                break;
     }
 
-    if (!adjacent(mon->pos(), you.pos()))
-    {
-        monster_die(*mon, KILL_DISMISSED, NON_MONSTER);
-        mpr("Could not put monster adjacent to player.");
-        return 0;
-    }
-
-    // prevent distracted stabbing
-    mon->foe = MHITYOU;
-    // this line is actually kind of important for distortion now
-    mon->hit_points = mon->max_hit_points = MAX_MONSTER_HP;
-    mon->behaviour = BEH_SEEK;
+    if (!_ready_fsim_monster(*mon, force_distance))
+        return nullptr;
 
     redraw_screen();
 
@@ -767,6 +790,7 @@ void wizard_fight_sim(bool double_scale)
             string error;
             if (_fsim_kit_equip(kit, error))
             {
+                redraw_screen();
                 _write_weapon(o);
                 fsim_proc(o, mon, defense, force_distance);
                 fprintf(o, "\n");
@@ -793,4 +817,290 @@ void wizard_fight_sim(bool double_scale)
     mpr("Done.");
 }
 
+// Batches of simulations run from the command line: see run_fsim_batch().
+
+struct fsim_batch_spec
+{
+    int line;
+    string species;
+    string job;
+    string skills;
+    string kit;
+    string monster;
+};
+
+static const char* _batch_title_line =
+    "Species\tJob\tSkills\tKit\tMonster\tMode\t";
+
+// An open field of floor with the player in the middle and nothing else on
+// it, so that every spec fights on the same ground.
+static void _fsim_batch_level()
+{
+    you.where_are_you = BRANCH_DUNGEON;
+    you.depth = 1;
+    dgn_reset_level();
+
+    for (rectangle_iterator ri(1); ri; ++ri)
+        grd(*ri) = DNGN_FLOOR;
+
+    you.moveto(coord_def(GXM / 2, GYM / 2));
+    los_changed();
+}
+
+// Set skills from a list like "xl:14, axes:20, fighting:12, weapon:27",
+// where "weapon" means the skill for whatever the player is wielding.
+static bool _fsim_batch_skills(const string &skills, string &error)
+{
+    for (const string &entry : split_string(",", skills))
+    {
+        const string::size_type sep = entry.find(":");
+        const int level = sep == string::npos ? -1
+                                              : atoi(entry.c_str() + sep + 1);
+        const string name =
+            lowercase_string(trimmed_string(entry.substr(0, sep)));
+
+        if (name == "xl" && level >= 1 && level <= 27)
+        {
+            set_xl(level, false);
+            continue;
+        }
+
+        const skill_type sk = name == "weapon" ? _equipped_skill()
+                                               : skill_from_name(name.c_str());
+        if (sk == SK_NONE || level < 0 || level > 27)
+        {
+            error = make_stringf("Bad skill level '%s'", entry.c_str());
+            return false;
+        }
+        set_skill_level(sk, level);
+    }
+    return true;
+}
+
+static bool _fsim_batch_fight(const fsim_batch_spec &spec, int index,
+                              FILE *out, string &error)
+{
+    _fsim_batch_level();
+
+    if (!spec.kit.empty() && !_fsim_kit_equip(spec.kit, error))
+    {
+        if (error.empty())
+            error = "Can't equip " + spec.kit;
+        return false;
+    }
+
+    if (!_fsim_batch_skills(spec.skills, error))
+        return false;
+
+    monster *mon = _create_fsim_monster(get_monster_by_name(spec.monster,
+                                                            true));
+    int force_distance = 0;
+    if (!mon || !_ready_fsim_monster(*mon, force_distance))
+    {
+        error = "Can't place " + spec.monster;
+        return false;
+    }
+
+    const string prefix = make_stringf("%s\t%s\t%s\t%s\t%s\t",
+                                       spec.species.c_str(),
+                                       spec.job.c_str(), spec.skills.c_str(),
+                                       spec.kit.c_str(),
+                                       spec.monster.c_str());
+    for (const bool defend : { false, true })
+    {
+        fight_data fdata = _get_fight_data(*mon, Options.fsim_rounds, defend,
+                                           force_distance);
+        const string mode = prefix + (defend ? "Defend\t" : "Attack\t");
+        for (const string &line : split_string("\n",
+                                               fdata.summary(mode, true)))
+        {
+            fprintf(out, "%d\t%s\n", index, line.c_str());
+        }
+    }
+
+    _uninit_fsim(mon);
+    return true;
+}
+
+// Simulate every jobs'th spec, starting from the worker'th, writing each
+// result line to out tagged with the index of its spec. Returns the number
+// of specs that failed.
+static int _fsim_batch_worker(const vector<fsim_batch_spec> &specs,
+                              int worker, int jobs, uint64_t seed, FILE *out)
+{
+    int errors = 0;
+    for (int i = worker; i < (int) specs.size(); i += jobs)
+    {
+        const fsim_batch_spec &spec = specs[i];
+        string error;
+
+        newgame_def ng;
+        ng.name = "Fsim";
+        ng.type = GAME_TYPE_CUSTOM_SEED;
+        ng.species = find_species_from_string(spec.species);
+        ng.job = get_job_by_name(spec.job.c_str());
+
+        if (ng.species == SP_UNKNOWN)
+            error = "Unknown species " + spec.species;
+        else if (ng.job == JOB_UNKNOWN)
+            error = "Unknown job " + spec.job;
+        else if (get_monster_by_name(spec.monster, true) == MONS_PROGRAM_BUG)
+            error = "Unknown monster " + spec.monster;
+        else
+        {
+            // Every character starts out the same way, and then has a
+            // generator of its own, so its results don't depend on which
+            // worker gets it or on what that worker did before.
+            Options.seed = seed;
+            setup_game(ng, false);
+            you.wizard = true;
+            {
+                rng::subgenerator spec_rng(seed, i);
+                _fsim_batch_fight(spec, i, out, error);
+            }
+            delete_files();
+        }
+
+        if (!error.empty())
+        {
+            fprintf(stderr, "line %d: %s\n", spec.line, error.c_str());
+            errors++;
+        }
+    }
+    fflush(out);
+    return errors;
+}
+
+static vector<fsim_batch_spec> _read_fsim_batch_specs(const string &filename)
+{
+    FILE *in = fopen_u(filename.c_str(), "r");
+    if (!in)
+        end(1, true, "Can't open fsim specs file %s", filename.c_str());
+
+    vector<fsim_batch_spec> specs;
+    char buf[1024];
+    for (int line = 1; fgets(buf, sizeof buf, in); ++line)
+    {
+        const string spec_line = trimmed_string(buf);
+        if (spec_line.empty() || spec_line[0] == '#')
+            continue;
+
+        vector<string> fields = split_string("|", spec_line, true, true);
+        if (fields.size() != 5)
+        {
+            end(1, false, "line %d: expected species | job | skills | kit "
+                          "| monster", line);
+        }
+        specs.push_back({ line, fields[0], fields[1], fields[2], fields[3],
+                          fields[4] });
+    }
+    fclose(in);
+    return specs;
+}
+
+/**
+ * Run the fight simulator headlessly over a file of specs, one per line:
+ *
+ *     species | job | skills | kit | monster
+ *
+ * e.g. "Minotaur | Fighter | xl:14, weapon:20, fighting:12 | war axe | ogre".
+ * The kit is as for the fsim_kit option (or empty for the starting kit),
+ * and each spec is fought for fsim_rounds rounds both attacking and
+ * defending. The specs are shared among jobs forked workers, and the TSV
+ * results written to stdout in the order of the file; given the same seed,
+ * the output doesn't depend on the number of workers.
+ */
+NORETURN void run_fsim_batch(const string &specs_file, int jobs)
+{
+    const vector<fsim_batch_spec> specs = _read_fsim_batch_specs(specs_file);
+
+    uint64_t seed = Options.seed_from_rc ? Options.seed_from_rc : Options.seed;
+    if (!seed)
+    {
+        rng::reset();
+        seed = crawl_state.seed;
+    }
+    fprintf(stderr, "fsim batch seed: %" PRIu64 "\n", seed);
+
+    // The characters are thrown away after each spec, and the workers
+    // mustn't fight over a save file.
+    Options.no_save = true;
+    initialise_item_descriptions();
+    initialise_branch_depths();
+    crawl_state.disables.set(DIS_CONFIRMATIONS);
+
+#ifdef TARGET_OS_WINDOWS
+    jobs = 1;
+#else
+    if (jobs <= 0)
+        jobs = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+    jobs = max(1, min(jobs, (int) specs.size()));
+
+    printf("%s%s\n", _batch_title_line, fight_data::header(true).c_str());
+    fflush(stdout);
+
+    bool failed = false;
+    vector<FILE *> outs;
+#ifdef TARGET_OS_WINDOWS
+    outs.push_back(tmpfile());
+    if (!outs[0])
+        end(1, true, "Can't create a temporary file");
+    failed = _fsim_batch_worker(specs, 0, 1, seed, outs[0]) > 0;
+#else
+    vector<pid_t> workers;
+    for (int worker = 0; worker < jobs; ++worker)
+    {
+        FILE *out = tmpfile();
+        if (!out)
+            end(1, true, "Can't create a temporary file");
+        fflush(stderr);
+
+        const pid_t pid = fork();
+        if (pid == -1)
+            end(1, true, "Can't fork fsim worker");
+        if (!pid)
+        {
+            const int errors = _fsim_batch_worker(specs, worker, jobs, seed,
+                                                  out);
+            fflush(stderr);
+            _exit(errors ? 1 : 0);
+        }
+        workers.push_back(pid);
+        outs.push_back(out);
+    }
+
+    for (pid_t pid : workers)
+    {
+        int status = 0;
+        if (waitpid(pid, &status, 0) == -1
+            || !WIFEXITED(status) || WEXITSTATUS(status))
+        {
+            failed = true;
+        }
+    }
+#endif
+
+    // Put the workers' results back in the order of the specs.
+    vector<string> results(specs.size());
+    for (FILE *out : outs)
+    {
+        rewind(out);
+        char buf[4096];
+        while (fgets(buf, sizeof buf, out))
+        {
+            char *line;
+            const long index = strtol(buf, &line, 10);
+            if (index >= 0 && index < (long) specs.size() && *line == '\t')
+                results[index] += line + 1;
+        }
+        fclose(out);
+    }
+
+    for (const string &result : results)
+        fputs(result.c_str(), stdout);
+
+    end(failed ? 1 : 0);
+}
+
 #endif
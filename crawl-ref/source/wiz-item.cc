@@ -871,6 +871,7 @@ static void _debug_acquirement_stats(FILE *ostat)
         return;
     }
     mitm[p].base_type = OBJ_UNASSIGNED;
+    item_slot_freed(p);
 
     clear_messages();
     mpr("[a] Weapons [b] Armours   [c] Jewellery [d] Books");